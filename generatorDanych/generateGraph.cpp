@@ -0,0 +1,315 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include "../src/binaryFormat.h"
+#include "../src/resultWriter.h"
+#include "../src/threadPool.h"
+
+using namespace std;
+
+// Scalable test graph generator.
+//
+//   ./genGraph <seed> <vertices> [--model gnm|grid|powerlaw] [--edges M | --saturation S]
+//              [--connected] [--keep P] [--diagonal P] [--exponent G]
+//              [--format json|binary] [--out file] [--threads N]
+//
+// gnm       uniform G(n, m), sampled without enumerating all vertex pairs
+// grid      road-like planar grid: each street kept with probability --keep, plus
+//           one diagonal per block with probability --diagonal
+// powerlaw  Chung-Lu graph with degree exponent --exponent and about M edges
+//
+// The work is cut into a fixed number of chunks, each with its own RNG derived from
+// the seed, so the output depends on the seed only, never on --threads.
+
+using Edge = pair<int, int>;
+
+static const int chunkCount = 64;
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static mt19937_64 chunkRng(uint64_t seed, uint64_t stream, uint64_t chunk) {
+    return mt19937_64(splitmix64(splitmix64(seed) ^ (stream << 32) ^ chunk));
+}
+
+// Runs body(chunk) for chunk = 0..chunkCount-1 on the pool and concatenates the results in chunk order.
+static vector<Edge> runChunks(ThreadPool& pool, const function<vector<Edge>(int)>& body) {
+    vector<future<vector<Edge>>> parts;
+    for (int c = 0; c < chunkCount; ++c) {
+        parts.push_back(pool.submit([&body, c]() { return body(c); }));
+    }
+    vector<Edge> edges;
+    for (auto& part : parts) {
+        vector<Edge> chunk = part.get();
+        edges.insert(edges.end(), chunk.begin(), chunk.end());
+    }
+    return edges;
+}
+
+// Maps k in [0, n(n-1)/2) to the k-th pair (i, j), i < j, in lexicographic order.
+static Edge decodePair(uint64_t k, int n) {
+    auto rowStart = [n](uint64_t i) { return i * (2 * static_cast<uint64_t>(n) - i - 1) / 2; };
+    double nn = 2.0 * n - 1;
+    uint64_t i = static_cast<uint64_t>(max(0.0, floor((nn - sqrt(nn * nn - 8.0 * static_cast<double>(k))) / 2)));
+    while (i > 0 && rowStart(i) > k) --i;
+    while (rowStart(i + 1) <= k) ++i;
+    return {static_cast<int>(i), static_cast<int>(i + 1 + (k - rowStart(i)))};
+}
+
+// Draws `count` distinct values from [0, range) in sorted order.
+static vector<uint64_t> sampleDistinct(uint64_t range, uint64_t count, mt19937_64& rng) {
+    bool complement = count > range / 2;
+    uint64_t target = complement ? range - count : count;
+    vector<uint64_t> picked;
+    uniform_int_distribution<uint64_t> dist(0, range == 0 ? 0 : range - 1);
+    while (picked.size() < target) {
+        while (picked.size() < target + target / 8 + 16) {
+            picked.push_back(dist(rng));
+        }
+        sort(picked.begin(), picked.end());
+        picked.erase(unique(picked.begin(), picked.end()), picked.end());
+        if (picked.size() > target) {
+            shuffle(picked.begin(), picked.end(), rng);
+            picked.resize(target);
+            sort(picked.begin(), picked.end());
+        }
+    }
+    if (!complement) {
+        return picked;
+    }
+    vector<uint64_t> result;
+    result.reserve(count);
+    size_t next = 0;
+    for (uint64_t k = 0; k < range; ++k) {
+        if (next < picked.size() && picked[next] == k) {
+            next++;
+        } else {
+            result.push_back(k);
+        }
+    }
+    return result;
+}
+
+// Uniform G(n, m): the pair index space is split into chunkCount ranges and each range
+// receives its proportional share of the m edges (never more than it has pairs).
+static vector<Edge> generateGnm(ThreadPool& pool, int n, uint64_t m, uint64_t seed) {
+    uint64_t pairs = static_cast<uint64_t>(n) * (n - 1) / 2;
+    m = min(m, pairs);
+    return runChunks(pool, [=](int c) {
+        uint64_t begin = pairs * c / chunkCount;
+        uint64_t end = pairs * (c + 1) / chunkCount;
+        // m * end reaches 10^19 and more at a few million vertices, so it is taken in 128 bits.
+        auto edgesBefore = [=](uint64_t k) {
+            return static_cast<uint64_t>(static_cast<unsigned __int128>(m) * k / max<uint64_t>(pairs, 1));
+        };
+        uint64_t share = edgesBefore(end) - edgesBefore(begin);
+        mt19937_64 rng = chunkRng(seed, 1, c);
+        vector<Edge> edges;
+        for (uint64_t k : sampleDistinct(end - begin, share, rng)) {
+            edges.push_back(decodePair(begin + k, n));
+        }
+        return edges;
+    });
+}
+
+// Road-like planar grid with rows of `cols` vertices; rows are split over the chunks.
+static vector<Edge> generateGrid(ThreadPool& pool, int n, double keep, double diagonal, uint64_t seed, int& cols) {
+    int rows = max(1, static_cast<int>(sqrt(static_cast<double>(n))));
+    cols = (n + rows - 1) / rows;
+    int c0 = cols;
+    return runChunks(pool, [=](int c) {
+        mt19937_64 rng = chunkRng(seed, 2, c);
+        uniform_real_distribution<double> coin(0.0, 1.0);
+        vector<Edge> edges;
+        for (int r = rows * c / chunkCount; r < rows * (c + 1) / chunkCount; ++r) {
+            for (int col = 0; col < c0; ++col) {
+                int u = r * c0 + col;
+                if (u >= n) break;
+                if (col + 1 < c0 && u + 1 < n && coin(rng) < keep) edges.emplace_back(u, u + 1);
+                if (u + c0 < n && coin(rng) < keep) edges.emplace_back(u, u + c0);
+                if (col + 1 < c0 && u + c0 + 1 < n && coin(rng) < diagonal) edges.emplace_back(u, u + c0 + 1);
+            }
+        }
+        return edges;
+    });
+}
+
+// Chung-Lu power-law graph sampled with the Miller-Hagberg skipping method in O(n + m).
+static vector<Edge> generatePowerLaw(ThreadPool& pool, int n, uint64_t m, double exponent, uint64_t seed) {
+    vector<double> weight(n);
+    double power = -1.0 / (exponent - 1.0);
+    for (int i = 0; i < n; ++i) {
+        weight[i] = pow(static_cast<double>(i + 1), power);
+    }
+    double scale = 2.0 * static_cast<double>(m) / accumulate(weight.begin(), weight.end(), 0.0);
+    for (double& w : weight) {
+        w *= scale;
+    }
+    double total = accumulate(weight.begin(), weight.end(), 0.0);
+    return runChunks(pool, [&weight, n, total, seed](int c) {
+        mt19937_64 rng = chunkRng(seed, 3, c);
+        uniform_real_distribution<double> coin(0.0, 1.0);
+        vector<Edge> edges;
+        // Rows are dealt round-robin because the heavy vertices come first.
+        for (int u = c; u < n - 1; u += chunkCount) {
+            int v = u + 1;
+            double p = min(weight[u] * weight[v] / total, 1.0);
+            while (v < n && p > 0) {
+                if (p != 1.0) {
+                    double r = coin(rng);
+                    v += static_cast<int>(floor(log(max(r, 1e-300)) / log(1.0 - p)));
+                }
+                if (v < n) {
+                    double q = min(weight[u] * weight[v] / total, 1.0);
+                    if (coin(rng) < q / p) {
+                        edges.emplace_back(u, v);
+                    }
+                    p = q;
+                    v++;
+                }
+            }
+        }
+        return edges;
+    });
+}
+
+static int findRoot(vector<int>& parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// Adds edges until the graph is connected. For the grid the missing streets are added
+// back (the graph stays planar); otherwise every other component is tied to a random
+// vertex of the component of vertex 0.
+static void connect(vector<Edge>& edges, int n, const string& model, int cols, uint64_t seed) {
+    vector<int> parent(n);
+    iota(parent.begin(), parent.end(), 0);
+    int components = n;
+    auto unite = [&](int u, int v) {
+        int a = findRoot(parent, u), b = findRoot(parent, v);
+        if (a == b) return false;
+        parent[b] = a;
+        components--;
+        return true;
+    };
+    for (const auto& [u, v] : edges) {
+        unite(u, v);
+    }
+    if (model == "grid") {
+        for (int u = 0; u < n && components > 1; ++u) {
+            if ((u % cols) + 1 < cols && u + 1 < n && unite(u, u + 1)) edges.emplace_back(u, u + 1);
+            if (u + cols < n && unite(u, u + cols)) edges.emplace_back(u, u + cols);
+        }
+        return;
+    }
+    mt19937_64 rng = chunkRng(seed, 4, 0);
+    vector<int> anchors;
+    for (int u = 0; u < n; ++u) {
+        if (findRoot(parent, u) == findRoot(parent, 0)) anchors.push_back(u);
+    }
+    for (int u = 1; u < n && components > 1; ++u) {
+        int anchor = anchors[uniform_int_distribution<size_t>(0, anchors.size() - 1)(rng)];
+        if (unite(anchor, u)) {
+            edges.emplace_back(min(anchor, u), max(anchor, u));
+        }
+    }
+}
+
+static bool writeJson(const string& path, int n, const vector<Edge>& edges) {
+    BufferedFile file(path, size_t(1) << 20);
+    if (!file.isOpen()) return false;
+    file.write("{\"edges\":[");
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (i) file.put(',');
+        file.put('[');
+        file.writeNumber(static_cast<long long>(edges[i].first));
+        file.put(',');
+        file.writeNumber(static_cast<long long>(edges[i].second));
+        file.put(']');
+    }
+    file.write("],\"vertices\":");
+    file.writeNumber(static_cast<long long>(n));
+    file.put('}');
+    return file.close();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " <seed> <vertices> [--model gnm|grid|powerlaw] [--edges M | --saturation S]"
+             << " [--connected] [--keep P] [--diagonal P] [--exponent G] [--format json|binary] [--out file] [--threads N]" << endl;
+        return 1;
+    }
+    uint64_t seed = stoull(argv[1]);
+    int n = stoi(argv[2]);
+    string model = "gnm", format = "json", out;
+    double saturation = -1, keep = 0.9, diagonal = 0.05, exponent = 2.5;
+    uint64_t m = 0;
+    bool connected = false;
+    unsigned threads = ThreadPool::defaultThreads();
+    for (int i = 3; i < argc; ++i) {
+        string arg = argv[i];
+        auto value = [&]() { return i + 1 < argc ? string(argv[++i]) : string(); };
+        if (arg == "--model") model = value();
+        else if (arg == "--edges") m = stoull(value());
+        else if (arg == "--saturation") saturation = stod(value());
+        else if (arg == "--connected") connected = true;
+        else if (arg == "--keep") keep = stod(value());
+        else if (arg == "--diagonal") diagonal = stod(value());
+        else if (arg == "--exponent") exponent = stod(value());
+        else if (arg == "--format") format = value();
+        else if (arg == "--out") out = value();
+        else if (arg == "--threads") threads = static_cast<unsigned>(stoi(value()));
+        else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    uint64_t pairs = static_cast<uint64_t>(n) * (n - 1) / 2;
+    if (saturation >= 0) {
+        m = static_cast<uint64_t>(saturation * static_cast<double>(pairs));
+    } else if (m == 0) {
+        m = 2 * static_cast<uint64_t>(n);
+    }
+    if (out.empty()) {
+        out = "graph_" + model + to_string(n) + (format == "binary" ? ".cpg" : ".json");
+    }
+
+    ThreadPool pool(threads);
+    vector<Edge> edges;
+    int cols = 0;
+    if (model == "gnm") {
+        edges = generateGnm(pool, n, m, seed);
+    } else if (model == "grid") {
+        edges = generateGrid(pool, n, keep, diagonal, seed, cols);
+    } else if (model == "powerlaw") {
+        edges = generatePowerLaw(pool, n, m, exponent, seed);
+    } else {
+        cerr << "Unknown model: " << model << endl;
+        return 1;
+    }
+    if (connected && n > 1) {
+        connect(edges, n, model, cols, seed);
+    }
+
+    bool ok = format == "binary" ? writeBinaryGraph(out, n, edges) : writeJson(out, n, edges);
+    if (!ok) {
+        cerr << "Failed to open file for writing." << endl;
+        return 1;
+    }
+    cout << "Graph with " << n << " vertices and " << edges.size() << " edges saved to " << out << endl;
+    return 0;
+}
@@ -1,70 +1,348 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
-#include <set>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
 #include <nlohmann/json.hpp> // Include the nlohmann/json library
+#include "../src/binaryFormat.h"
 
 using json = nlohmann::json;
 using namespace std;
 
-// Function to read JSON data from a file
-json readJsonFromFile(const string& filePath) {
-    ifstream file(filePath);
+// Usage: ./testJson <graph file> <results file> [--threads N]
+// The graph may be JSON or the binary graph format, the results JSON or compact (.cpr).
+//
+// Verifies a solution against its graph and prints a JSON report to stdout:
+// - every graph edge is covered by some route (hashed edge index + atomic bitset); an edge
+//   listed more than once in the graph counts once,
+// - every step of a route is a graph edge and each route is one continuous walk,
+// - the reported per-route costs and the total cost match the routes,
+// - balance statistics of the route costs.
+// Postmen are checked in parallel. Exit status: 0 valid, 2 invalid, 1 error.
+
+/**
+ * @brief SAX handler collecting [u, v] pairs found at a fixed nesting level under given keys.
+ *
+ * Used for both input files so that neither is materialized as a JSON DOM:
+ * the graph's "edges" array and every postman's "routes" array with its "cost".
+ */
+struct PairCollector : nlohmann::json_sax<json> {
+    bool results = false;          // parsing a results file (postmen/routes) instead of a graph
+    vector<int> kinds;             // open containers: 'o' object, 'a' array
+    vector<std::string> keys;      // last key seen in every open object
+    vector<int> current;           // numbers of the [u, v] array being read
+
+    int vertices = 0;
+    vector<int> flat;              // u0, v0, u1, v1, ... for all pairs in order
+    vector<size_t> routeStart;     // results: first pair index of each postman
+    vector<double> reportedCost;   // results: "cost" of each postman
+    bool hasTotalCost = false;
+    double totalCost = 0;
+
+    bool inPairList() const {
+        if (!results) {
+            return kinds.size() == 3 && keys[0] == "edges";
+        }
+        return kinds.size() == 5 && keys[0] == "postmen" && keys[2] == "routes";
+    }
+
+    bool number(double value) {
+        if (inPairList()) {
+            current.push_back(static_cast<int>(value));
+        } else if (!results && kinds.size() == 1 && keys[0] == "vertices") {
+            vertices = static_cast<int>(value);
+        } else if (results && kinds.size() == 3 && keys[0] == "postmen" && keys[2] == "cost") {
+            reportedCost.back() = value;
+        } else if (results && kinds.size() == 1 && keys[0] == "totalCost") {
+            hasTotalCost = true;
+            totalCost = value;
+        }
+        return true;
+    }
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { return number(static_cast<double>(value)); }
+    bool number_unsigned(number_unsigned_t value) override { return number(static_cast<double>(value)); }
+    bool number_float(number_float_t value, const string_t&) override { return number(value); }
+    bool string(string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+    bool start_object(size_t) override {
+        kinds.push_back('o');
+        keys.emplace_back();
+        if (results && kinds.size() == 3 && keys[0] == "postmen") {
+            routeStart.push_back(flat.size() / 2);
+            reportedCost.push_back(0);
+        }
+        return true;
+    }
+    bool key(string_t& name) override {
+        keys.back() = name;
+        return true;
+    }
+    bool end_object() override {
+        kinds.pop_back();
+        keys.pop_back();
+        return true;
+    }
+    bool start_array(size_t) override {
+        kinds.push_back('a');
+        keys.emplace_back();
+        current.clear();
+        return true;
+    }
+    bool end_array() override {
+        if (inPairList() && current.size() == 2) {
+            flat.push_back(current[0]);
+            flat.push_back(current[1]);
+        }
+        current.clear();
+        kinds.pop_back();
+        keys.pop_back();
+        return true;
+    }
+    bool parse_error(size_t position, const std::string&, const nlohmann::detail::exception& ex) override {
+        throw runtime_error("JSON parse error at byte " + to_string(position) + ": " + ex.what());
+    }
+};
+
+static void parseJsonFile(const string& path, PairCollector& collector) {
+    ifstream file(path);
     if (!file) {
-        throw runtime_error("Could not open file: " + filePath);
+        throw runtime_error("Could not open file: " + path);
     }
-    json data;
-    file >> data;
-    return data;
+    json::sax_parse(file, &collector);
 }
 
-// Function to create a set of undirected edges from a list of edges
-set<pair<int, int>> createEdgeSet(const vector<vector<int>>& edges) {
-    set<pair<int, int>> edgeSet;
-    for (const auto& edge : edges) {
-        if (edge.size() != 2) continue;
-        int u = edge[0], v = edge[1];
-        if (u > v) std::swap(u, v); // Ensure (u, v) is ordered
-        edgeSet.emplace(u, v);
+/**
+ * @brief Open-addressing hash map from an undirected edge to its index in the graph's edge list.
+ *
+ * Repeated edges are dropped from the list (the first one stays), as the solver's adjacency
+ * matrix holds every edge once and a route only has to cover it once.
+ */
+class EdgeIndex {
+public:
+    explicit EdgeIndex(vector<int>& flat) {
+        size_t edges = flat.size() / 2;
+        size_t capacity = 16;
+        while (capacity < edges * 2) capacity <<= 1;
+        shift = 64 - static_cast<int>(log2(static_cast<double>(capacity)));
+        keys.assign(capacity, emptyKey);
+        ids.assign(capacity, -1);
+        size_t kept = 0;
+        for (size_t e = 0; e < edges; ++e) {
+            uint64_t k = key(flat[2 * e], flat[2 * e + 1]);
+            size_t slot = find(k);
+            if (keys[slot] == emptyKey) {
+                keys[slot] = k;
+                ids[slot] = static_cast<long long>(kept);
+                flat[2 * kept] = flat[2 * e];
+                flat[2 * kept + 1] = flat[2 * e + 1];
+                kept++;
+            }
+        }
+        flat.resize(2 * kept);
+    }
+
+    long long lookup(int u, int v) const {
+        size_t slot = find(key(u, v));
+        return keys[slot] == emptyKey ? -1 : ids[slot];
+    }
+
+private:
+    static constexpr uint64_t emptyKey = ~uint64_t(0);
+
+    static uint64_t key(int u, int v) {
+        if (u > v) swap(u, v);
+        return (static_cast<uint64_t>(static_cast<uint32_t>(u)) << 32) | static_cast<uint32_t>(v);
+    }
+
+    size_t find(uint64_t k) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = static_cast<size_t>((k * 0x9E3779B97F4A7C15ull) >> shift);
+        while (keys[slot] != emptyKey && keys[slot] != k) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    int shift;
+    vector<uint64_t> keys;
+    vector<long long> ids;
+};
+
+struct PostmanReport {
+    long long steps = 0;
+    long long cost = 0;
+    long long invalidSteps = 0;
+    long long discontinuities = 0;
+    bool costMatches = true;
+};
+
+int main(int argc, char* argv[]) {
+    vector<string> positional;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = max(1, stoi(argv[++i]));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        cerr << "Usage: " << argv[0] << " <graph file> <results file> [--threads N]" << endl;
+        return 1;
     }
-    return edgeSet;
-}
 
-int main() {
     try {
-        json file1 = readJsonFromFile("graph.json");
-        json file2 = readJsonFromFile("results.json");
-
-        vector<vector<int>> edgesFile1 = file1["edges"];
-        auto edgesSetFile1 = createEdgeSet(edgesFile1);
-
-        set<pair<int, int>> edgesSetFile2;
-        for (const auto& postman : file2["postmen"]) {
-            for (const auto& route : postman["routes"]) {
-                if (route.size() != 2) continue;
-                int u = route[0], v = route[1];
-                if (u > v) swap(u, v);
-                edgesSetFile2.emplace(u, v);
+        auto started = chrono::steady_clock::now();
+
+        PairCollector graph;
+        if (isBinaryGraph(positional[0])) {
+            vector<pair<int, int>> binaryEdges;
+            readBinaryGraph(positional[0], graph.vertices, binaryEdges);
+            for (const auto& [u, v] : binaryEdges) {
+                graph.flat.push_back(u);
+                graph.flat.push_back(v);
             }
+        } else {
+            parseJsonFile(positional[0], graph);
         }
+        size_t inputEdges = graph.flat.size() / 2;
+        EdgeIndex index(graph.flat);
+        size_t edges = graph.flat.size() / 2;
 
-        bool allEdgesIncluded = true;
-        for (const auto& edge : edgesSetFile1) {
-            if (edgesSetFile2.find(edge) == edgesSetFile2.end()) {
-                std::cout << "Missing edge: (" << edge.first << ", " << edge.second << ")\n";
-                allEdgesIncluded = false;
+        // Routes as a flat list of (u, v) steps plus the first step of every postman.
+        PairCollector results;
+        results.results = true;
+        if (isCompactRoutes(positional[1])) {
+            CompactSolution solution = readCompactRoutes(positional[1]);
+            for (const auto& postman : solution.postmen) {
+                results.routeStart.push_back(results.flat.size() / 2);
+                results.reportedCost.push_back(static_cast<double>(postman.cost));
+                for (const auto& walk : postman.walks) {
+                    for (size_t i = 0; i + 1 < walk.size(); ++i) {
+                        results.flat.push_back(walk[i]);
+                        results.flat.push_back(walk[i + 1]);
+                    }
+                }
             }
+            results.hasTotalCost = solution.hasTotalCost;
+            results.totalCost = static_cast<double>(solution.totalCost);
+        } else {
+            parseJsonFile(positional[1], results);
         }
+        size_t postmen = results.routeStart.size();
+        results.routeStart.push_back(results.flat.size() / 2);
 
-        if (allEdgesIncluded) {
-            std::cout << "All edges from file1 are included in file2.\n";
-        } else {
-            std::cout << "Some edges from file1 are missing in file2.\n";
+        vector<atomic<uint64_t>> covered((edges + 63) / 64);
+        for (auto& word : covered) {
+            word.store(0, memory_order_relaxed);
         }
+        vector<PostmanReport> reports(postmen);
+        atomic<size_t> nextPostman{0};
+
+        auto worker = [&]() {
+            for (size_t p = nextPostman++; p < postmen; p = nextPostman++) {
+                PostmanReport& report = reports[p];
+                for (size_t s = results.routeStart[p]; s < results.routeStart[p + 1]; ++s) {
+                    int u = results.flat[2 * s];
+                    int v = results.flat[2 * s + 1];
+                    if (s > results.routeStart[p] && results.flat[2 * s - 1] != u) {
+                        report.discontinuities++;
+                    }
+                    report.steps++;
+                    long long e = (u < 0 || v < 0) ? -1 : index.lookup(u, v);
+                    if (e < 0) {
+                        report.invalidSteps++;
+                        continue;
+                    }
+                    report.cost++;
+                    covered[e / 64].fetch_or(uint64_t(1) << (e % 64), memory_order_relaxed);
+                }
+                report.costMatches = llround(results.reportedCost[p]) == report.cost;
+            }
+        };
+        vector<thread> pool;
+        for (unsigned t = 1; t < min<size_t>(threads, max<size_t>(postmen, 1)); ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool) {
+            t.join();
+        }
+
+        long long coveredEdges = 0;
+        json missingSample = json::array();
+        for (size_t e = 0; e < edges; ++e) {
+            if ((covered[e / 64].load(memory_order_relaxed) >> (e % 64)) & 1) {
+                coveredEdges++;
+            } else if (missingSample.size() < 10) {
+                missingSample.push_back({graph.flat[2 * e], graph.flat[2 * e + 1]});
+            }
+        }
+
+        long long invalidSteps = 0, discontinuities = 0, costMismatches = 0, steps = 0, computedTotal = 0;
+        long long minCost = postmen ? reports[0].cost : 0, maxCost = minCost;
+        for (const auto& report : reports) {
+            invalidSteps += report.invalidSteps;
+            discontinuities += report.discontinuities;
+            costMismatches += report.costMatches ? 0 : 1;
+            steps += report.steps;
+            computedTotal += report.cost;
+            minCost = min(minCost, report.cost);
+            maxCost = max(maxCost, report.cost);
+        }
+        double mean = postmen ? static_cast<double>(computedTotal) / postmen : 0;
+        double variance = 0;
+        for (const auto& report : reports) {
+            variance += (report.cost - mean) * (report.cost - mean);
+        }
+        double stddev = postmen ? sqrt(variance / postmen) : 0;
+        bool totalMatches = !results.hasTotalCost || llround(results.totalCost) == computedTotal;
+        long long missingEdges = static_cast<long long>(edges) - coveredEdges;
+        bool valid = missingEdges == 0 && invalidSteps == 0 && discontinuities == 0 &&
+                     costMismatches == 0 && totalMatches;
+
+        json report;
+        report["graph"] = positional[0];
+        report["results"] = positional[1];
+        report["vertices"] = graph.vertices;
+        report["edges"] = edges;
+        report["duplicateEdges"] = inputEdges - edges;
+        report["postmen"] = postmen;
+        report["coveredEdges"] = coveredEdges;
+        report["missingEdges"] = missingEdges;
+        report["missingSample"] = missingSample;
+        report["steps"] = steps;
+        report["deadheadSteps"] = steps - invalidSteps - coveredEdges;
+        report["invalidSteps"] = invalidSteps;
+        report["discontinuities"] = discontinuities;
+        report["costMismatches"] = costMismatches;
+        report["computedTotalCost"] = computedTotal;
+        if (results.hasTotalCost) {
+            report["reportedTotalCost"] = llround(results.totalCost);
+        }
+        report["totalCostMatches"] = totalMatches;
+        report["balance"] = {
+            {"min", minCost},
+            {"max", maxCost},
+            {"mean", mean},
+            {"stddev", stddev},
+            {"maxOverMean", mean > 0 ? maxCost / mean : 0.0}
+        };
+        report["valid"] = valid;
+        report["seconds"] = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        cout << report.dump(2) << endl;
+        return valid ? 0 : 2;
     } catch (const std::exception& ex) {
         std::cerr << "Error: " << ex.what() << "\n";
         return 1;
     }
-
-    return 0;
 }
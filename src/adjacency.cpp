@@ -0,0 +1,145 @@
+#include "adjacency.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @file adjacency.cpp
+ * @brief Picks the layout that stores the expected number of edges in fewer bytes.
+ *
+ * A neighbour list costs two ints per edge, a bitset row costs one bit per vertex pair,
+ * so the bitset wins once more than 1/32 of all possible edges are present.
+ *
+ * @param vertices The number of vertices in the graph.
+ * @param expectedEdges The number of undirected edges that will be added.
+ * @return The layout to pass to reset().
+ */
+AdjacencyIndex::Layout AdjacencyIndex::chooseLayout(int vertices, long long expectedEdges) {
+    if (vertices < 2) {
+        return Layout::Sparse;
+    }
+    double possible = static_cast<double>(vertices) * (vertices - 1) / 2.0;
+    return expectedEdges / possible > denseThreshold ? Layout::Dense : Layout::Sparse;
+}
+
+void AdjacencyIndex::reset(int v, Layout l) {
+    vertices = v;
+    layout = l;
+    edges = 0;
+    words = (v + 63) / 64;
+    bits.clear();
+    lists.clear();
+    if (layout == Layout::Dense) {
+        bits.assign(static_cast<size_t>(v) * words, 0);
+    } else {
+        lists.resize(v);
+    }
+}
+
+/**
+ * @brief Adds the undirected edge (u, v).
+ *
+ * @return true if the edge was not present before, false if it already existed.
+ */
+bool AdjacencyIndex::add(int u, int v) {
+    if (has(u, v)) {
+        return false;
+    }
+    if (layout == Layout::Dense) {
+        bits[static_cast<size_t>(u) * words + v / 64] |= uint64_t(1) << (v % 64);
+        bits[static_cast<size_t>(v) * words + u / 64] |= uint64_t(1) << (u % 64);
+    } else {
+        lists[u].insert(upper_bound(lists[u].begin(), lists[u].end(), v), v);
+        if (u != v) {
+            lists[v].insert(upper_bound(lists[v].begin(), lists[v].end(), u), u);
+        }
+    }
+    edges++;
+    return true;
+}
+
+/**
+ * @brief Removes the undirected edge (u, v).
+ *
+ * @return true if the edge was present, false otherwise.
+ */
+bool AdjacencyIndex::remove(int u, int v) {
+    if (!has(u, v)) {
+        return false;
+    }
+    if (layout == Layout::Dense) {
+        bits[static_cast<size_t>(u) * words + v / 64] &= ~(uint64_t(1) << (v % 64));
+        bits[static_cast<size_t>(v) * words + u / 64] &= ~(uint64_t(1) << (u % 64));
+    } else {
+        lists[u].erase(lower_bound(lists[u].begin(), lists[u].end(), v));
+        if (u != v) {
+            lists[v].erase(lower_bound(lists[v].begin(), lists[v].end(), u));
+        }
+    }
+    edges--;
+    return true;
+}
+
+bool AdjacencyIndex::has(int u, int v) const {
+    if (layout == Layout::Dense) {
+        return (bits[static_cast<size_t>(u) * words + v / 64] >> (v % 64)) & 1;
+    }
+    return binary_search(lists[u].begin(), lists[u].end(), v);
+}
+
+/**
+ * @brief Returns the degree of u.
+ *
+ * In the dense layout this is a popcount over the row's words.
+ */
+int AdjacencyIndex::degree(int u) const {
+    if (layout == Layout::Dense) {
+        const uint64_t* row = &bits[static_cast<size_t>(u) * words];
+        int degree = 0;
+        for (int w = 0; w < words; ++w) {
+            degree += __builtin_popcountll(row[w]);
+        }
+        return degree;
+    }
+    return static_cast<int>(lists[u].size());
+}
+
+/**
+ * @brief Get the vertices with odd degrees.
+ *
+ * @return A vector of pairs (vertex, degree) in increasing vertex order.
+ */
+vector<pair<int, int>> AdjacencyIndex::oddDegreeVertices() const {
+    vector<pair<int, int>> oddVertices;
+    for (int i = 0; i < vertices; ++i) {
+        int d = degree(i);
+        if (d % 2 != 0) {
+            oddVertices.emplace_back(i, d);
+        }
+    }
+    return oddVertices;
+}
+
+/**
+ * @brief Checks whether every vertex has even degree.
+ *
+ * In the dense layout only the parity is needed, so the row words are folded
+ * with XOR and a single popcount decides the parity of the whole row.
+ */
+bool AdjacencyIndex::allDegreesEven() const {
+    for (int i = 0; i < vertices; ++i) {
+        if (layout == Layout::Dense) {
+            const uint64_t* row = &bits[static_cast<size_t>(i) * words];
+            uint64_t folded = 0;
+            for (int w = 0; w < words; ++w) {
+                folded ^= row[w];
+            }
+            if (__builtin_popcountll(folded) % 2 != 0) {
+                return false;
+            }
+        } else if (lists[i].size() % 2 != 0) {
+            return false;
+        }
+    }
+    return true;
+}
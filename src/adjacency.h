@@ -0,0 +1,74 @@
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+/**
+ * @file adjacency.h
+ * @brief Structural adjacency index used for degree, parity and neighbour queries.
+ *
+ * The index stores the same undirected simple graph in one of two layouts:
+ * - Sparse: one sorted neighbour list per vertex.
+ * - Dense: one bitset row per vertex packed into 64-bit words, so a row of
+ *   V vertices costs V/8 bytes instead of 4V bytes for a row of ints.
+ *
+ * The layout is picked from the edge density when the index is reset; both
+ * layouts answer the same queries.
+ */
+class AdjacencyIndex {
+public:
+    enum class Layout { Sparse, Dense };
+
+    /// Density (edges / possible edges) above which the bitset rows are smaller than neighbour lists.
+    static constexpr double denseThreshold = 1.0 / 32.0;
+
+    static Layout chooseLayout(int vertices, long long expectedEdges);
+
+    void reset(int vertices, Layout layout);
+    Layout getLayout() const { return layout; }
+
+    bool add(int u, int v);
+    bool remove(int u, int v);
+    bool has(int u, int v) const;
+    int degree(int u) const;
+    long long edgeCount() const { return edges; }
+
+    std::vector<std::pair<int, int>> oddDegreeVertices() const;
+    bool allDegreesEven() const;
+
+    /**
+     * @brief Calls f(v) for every neighbour v of u in increasing order.
+     *
+     * In the dense layout the row is walked a word at a time and empty words are skipped.
+     */
+    template <typename F>
+    void forEachNeighbour(int u, F&& f) const {
+        if (layout == Layout::Dense) {
+            const uint64_t* row = &bits[static_cast<size_t>(u) * words];
+            for (int w = 0; w < words; ++w) {
+                uint64_t word = row[w];
+                while (word) {
+                    f(w * 64 + __builtin_ctzll(word));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (int v : lists[u]) {
+                f(v);
+            }
+        }
+    }
+
+private:
+    int vertices = 0;
+    int words = 0;
+    long long edges = 0;
+    Layout layout = Layout::Sparse;
+    std::vector<uint64_t> bits;
+    std::vector<std::vector<int>> lists;
+};
+
+#endif // ADJACENCY_H
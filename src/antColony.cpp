@@ -0,0 +1,372 @@
+#include "antColony.h"
+#include "graph.h"
+#include "threadPool.h"
+#include "resultWriter.h"
+#include "lowerBound.h"
+#include "memoryStats.h"
+#include "trace.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+
+using namespace std;
+
+/**
+ * @brief Per-thread state of one ant, sized by the first ant and reused by the following ones.
+ *
+ * The unserved edges of u are the slots [offset[u], offset[u] + unserved[u]) of open; a
+ * served edge is swapped behind that range on both of its ends.
+ */
+struct AntColony::Scratch {
+    vector<pair<int, int>> open;
+    vector<int> slotOf;    ///< Current slot of 2 * edge ID + dir in open.
+    vector<int> unserved;  ///< Unserved edges per vertex.
+    vector<long long> cost;
+    vector<int> at;
+    vector<int> home;      ///< Index of every postman's current component in its homes.
+    vector<char> done;     ///< Postmen whose components are all served.
+    vector<double> weight;
+    // Breadth-first search of walkToUnserved.
+    vector<int> seen;
+    vector<int> parent;
+    vector<int> queue;
+    vector<pair<int, int>> path;
+    int epoch = 0;
+};
+
+/**
+ * @brief Builds the edge IDs, incidence lists and connected components of a simple undirected graph.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The edges, each listed once.
+ */
+AntColony::AntColony(int vertices, const vector<pair<int, int>>& edges) : vertices(vertices) {
+    int m = static_cast<int>(edges.size());
+    edgeU.resize(m);
+    edgeV.resize(m);
+    offset.assign(vertices + 1, 0);
+    for (int id = 0; id < m; ++id) {
+        edgeU[id] = edges[id].first;
+        edgeV[id] = edges[id].second;
+        offset[edgeU[id] + 1]++;
+        offset[edgeV[id] + 1]++;
+    }
+    for (int u = 0; u < vertices; ++u) {
+        offset[u + 1] += offset[u];
+    }
+    incident.resize(2 * static_cast<size_t>(m));
+    edgeSlot.resize(2 * static_cast<size_t>(m));
+    vector<int> fill(offset.begin(), offset.end() - 1);
+    for (int id = 0; id < m; ++id) {
+        edgeSlot[2 * id] = fill[edgeU[id]];
+        incident[fill[edgeU[id]]++] = {edgeV[id], id};
+        edgeSlot[2 * id + 1] = fill[edgeV[id]];
+        incident[fill[edgeV[id]]++] = {edgeU[id], id};
+    }
+    pheromone.assign(2 * static_cast<size_t>(m), maxPheromone);
+
+    vector<int> component(vertices, -1);
+    vector<int> queue;
+    for (int id = 0; id < m; ++id) {
+        if (component[edgeU[id]] != -1) {
+            continue;
+        }
+        int c = static_cast<int>(componentEdges.size());
+        componentEdges.emplace_back();
+        component[edgeU[id]] = c;
+        queue.assign(1, edgeU[id]);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int x = queue[head];
+            for (int slot = offset[x]; slot < offset[x + 1]; ++slot) {
+                const auto& [y, e] = incident[slot];
+                if (x == edgeU[e]) {
+                    componentEdges[c].push_back(e);
+                }
+                if (component[y] == -1) {
+                    component[y] = c;
+                    queue.push_back(y);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns a vertex of a component that still has an unserved edge, or -1.
+ */
+int AntColony::unservedVertex(int component, const Scratch& s) const {
+    for (int id : componentEdges[component]) {
+        if (s.unserved[edgeU[id]] > 0) {
+            return edgeU[id];
+        }
+        if (s.unserved[edgeV[id]] > 0) {
+            return edgeV[id];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Appends a shortest path from u to the nearest vertex with an unserved edge.
+ *
+ * @return false if no such vertex is reachable from u.
+ */
+bool AntColony::walkToUnserved(int u, Scratch& s, vector<pair<int, int>>& route) const {
+    if (++s.epoch == numeric_limits<int>::max()) {
+        fill(s.seen.begin(), s.seen.end(), 0);
+        s.epoch = 1;
+    }
+    s.queue.clear();
+    s.queue.push_back(u);
+    s.seen[u] = s.epoch;
+    int found = -1;
+    for (size_t head = 0; head < s.queue.size() && found == -1; ++head) {
+        int x = s.queue[head];
+        for (int slot = offset[x]; slot < offset[x + 1]; ++slot) {
+            int y = incident[slot].first;
+            if (s.seen[y] == s.epoch) {
+                continue;
+            }
+            s.seen[y] = s.epoch;
+            s.parent[y] = x;
+            if (s.unserved[y] > 0) {
+                found = y;
+                break;
+            }
+            s.queue.push_back(y);
+        }
+    }
+    if (found == -1) {
+        return false;
+    }
+    s.path.clear();
+    for (int v = found; v != u; v = s.parent[v]) {
+        s.path.emplace_back(s.parent[v], v);
+    }
+    route.insert(route.end(), s.path.rbegin(), s.path.rend());
+    return true;
+}
+
+/**
+ * @brief Lets one ant build a complete tour.
+ *
+ * @param homes The components of every postman, in the order it serves them.
+ * @param seed Seed of the ant's generator.
+ * @param s The calling thread's scratch state.
+ * @param tour Receives the routes and the longest route cost.
+ * @param served Receives the directed edge slots (2 * id + dir) in the order they were served.
+ */
+void AntColony::construct(const vector<vector<int>>& homes, uint32_t seed, Scratch& s, Tour& tour,
+                          vector<int>& served) const {
+    mt19937 rng(seed);
+    int postmen = static_cast<int>(homes.size());
+    int m = getEdges();
+    s.open = incident;
+    s.slotOf = edgeSlot;
+    s.unserved.resize(vertices);
+    for (int u = 0; u < vertices; ++u) {
+        s.unserved[u] = offset[u + 1] - offset[u];
+    }
+    s.seen.resize(vertices, 0);
+    s.parent.resize(vertices);
+    s.weight.resize(candidateLimit);
+    s.cost.assign(postmen, 0);
+    s.at.resize(postmen);
+    s.home.assign(postmen, 0);
+    s.done.assign(postmen, 0);
+    tour.routes.resize(postmen);
+    served.clear();
+
+    auto serve = [&](int id, int from) {
+        for (int dir = 0; dir < 2; ++dir) {
+            int w = dir == 0 ? edgeU[id] : edgeV[id];
+            int last = offset[w] + --s.unserved[w];
+            int slot = s.slotOf[2 * id + dir];
+            int moved = s.open[last].second;
+            swap(s.open[slot], s.open[last]);
+            s.slotOf[2 * moved + (edgeU[moved] == w ? 0 : 1)] = slot;
+            s.slotOf[2 * id + dir] = last;
+        }
+        served.push_back(2 * id + (from == edgeU[id] ? 0 : 1));
+    };
+
+    for (int p = 0; p < postmen; ++p) {
+        tour.routes[p].clear();
+        if (homes[p].empty()) {
+            s.done[p] = 1;
+            continue;
+        }
+        const vector<int>& edges = componentEdges[homes[p][0]];
+        s.at[p] = edgeU[edges[rng() % edges.size()]];
+    }
+    for (int remaining = m; remaining > 0;) {
+        int p = -1;
+        for (int q = 0; q < postmen; ++q) {
+            if (!s.done[q] && (p == -1 || s.cost[q] < s.cost[p])) {
+                p = q;
+            }
+        }
+        int u = s.at[p];
+        vector<pair<int, int>>& route = tour.routes[p];
+        if (s.unserved[u] == 0) {
+            size_t before = route.size();
+            if (walkToUnserved(u, s, route)) {
+                s.cost[p] += static_cast<long long>(route.size() - before);
+                s.at[p] = route.back().second;
+                continue;
+            }
+            // The component is served; go on with the next one of this postman, if any.
+            int next = -1;
+            while (next == -1 && ++s.home[p] < static_cast<int>(homes[p].size())) {
+                next = unservedVertex(homes[p][s.home[p]], s);
+            }
+            if (next == -1) {
+                s.done[p] = 1;
+            } else {
+                s.at[p] = next;
+            }
+            continue;
+        }
+
+        // A window of at most candidateLimit unserved edges, at a random place if there are more.
+        int count = min(s.unserved[u], candidateLimit);
+        int first = offset[u] + (s.unserved[u] > candidateLimit ? static_cast<int>(rng() % (s.unserved[u] - count + 1)) : 0);
+        double total = 0;
+        for (int c = 0; c < count; ++c) {
+            const auto& [v, id] = s.open[first + c];
+            double ahead = s.unserved[v];
+            s.weight[c] = pheromone[2 * id + (u == edgeU[id] ? 0 : 1)] * ahead * ahead;
+            total += s.weight[c];
+        }
+        double pick = total * (rng() * (1.0 / 4294967296.0));
+        int chosen = 0;
+        while (chosen + 1 < count && pick >= s.weight[chosen]) {
+            pick -= s.weight[chosen++];
+        }
+        auto [v, id] = s.open[first + chosen];
+        serve(id, u);
+        route.emplace_back(u, v);
+        s.cost[p]++;
+        s.at[p] = v;
+        remaining--;
+    }
+    tour.longest = m > 0 ? *max_element(s.cost.begin(), s.cost.end()) : 0;
+}
+
+/**
+ * @brief Runs the colony and returns the best tour found.
+ *
+ * The postmen are spread over the connected components by allocatePostmen.
+ *
+ * @param postmen The number of routes.
+ * @param iterations The number of pheromone updates.
+ * @param ants The number of ants per iteration.
+ * @param threads The number of worker threads.
+ * @param seed Seed of the whole run.
+ */
+AntColony::Tour AntColony::solve(int postmen, int iterations, int ants, unsigned threads, uint32_t seed) {
+    vector<long long> work;
+    for (const auto& edges : componentEdges) {
+        work.push_back(static_cast<long long>(edges.size()));
+    }
+    vector<vector<int>> owners;
+    allocatePostmen(work, postmen, owners);
+    vector<vector<int>> homes(postmen);
+    for (size_t c = 0; c < owners.size(); ++c) {
+        for (int p : owners[c]) {
+            homes[p].push_back(static_cast<int>(c));
+        }
+    }
+
+    Tour best;
+    vector<Tour> tours(ants);
+    vector<vector<int>> served(ants);
+    long long bound = (getEdges() + postmen - 1) / postmen;
+    ThreadPool pool(threads);
+    for (int it = 0; it < iterations; ++it) {
+        TraceScope trace("ant iteration", it);
+        parallelFor(pool, static_cast<size_t>(ants), [&](size_t begin, size_t end) {
+            thread_local Scratch scratch;
+            for (size_t a = begin; a < end; ++a) {
+                seed_seq antSeed{seed, static_cast<uint32_t>(it), static_cast<uint32_t>(a)};
+                uint32_t value;
+                antSeed.generate(&value, &value + 1);
+                construct(homes, value, scratch, tours[a], served[a]);
+            }
+        });
+
+        int winner = 0;
+        for (int a = 1; a < ants; ++a) {
+            if (tours[a].longest < tours[winner].longest) {
+                winner = a;
+            }
+        }
+        if (best.longest < 0 || tours[winner].longest < best.longest) {
+            best = tours[winner];
+        }
+
+        for (float& tau : pheromone) {
+            tau *= 1.0f - evaporation;
+        }
+        float amount = evaporation * static_cast<float>(bound) / static_cast<float>(max(tours[winner].longest, 1LL));
+        for (int slot : served[winner]) {
+            pheromone[slot] += amount;
+        }
+        for (float& tau : pheromone) {
+            tau = min(max(tau, minPheromone), maxPheromone);
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Solves the k-postman problem with the ant colony and writes resultsAnts.json.
+ *
+ * Prints the longest route against the lower bound, like the other solvers, and the
+ * routes unless --quiet is given.
+ *
+ * @param n The number of postmen.
+ * @param iterations The number of colony iterations.
+ */
+void Graph::solveAnts(int n, int iterations) {
+    PhaseScope phase(Phase::Ants);
+    vector<pair<int, int>> edges;
+    vector<WeightedEdge> weighted = getWeightedEdges();
+    edges.reserve(weighted.size());
+    for (const auto& e : weighted) {
+        edges.emplace_back(e.u, e.v);
+    }
+    RouteLowerBound bound = minMaxLowerBound(vertices, weighted, n);
+    AntColony colony(vertices, edges);
+    AntColony::Tour tour = colony.solve(n, iterations, options.ants, ThreadPool::defaultThreads(), static_cast<uint32_t>(seed));
+
+    string outputPath = resultPath("resultsAnts", options.format);
+    unique_ptr<RouteWriter> writer = openRouteWriter(outputPath, options.format);
+    long long totalCost = 0;
+    for (int i = 0; i < n; ++i) {
+        const auto& route = tour.routes[i];
+        if (!options.quiet) {
+            cout << "Postman " << i + 1 << " ant route: ";
+            for (const auto& [u, v] : route) {
+                cout << "(" << originalVertex(u) << ", " << originalVertex(v) << ") ";
+            }
+            cout << '\n';
+        }
+        writer->beginPostman();
+        for (const auto& [u, v] : route) {
+            writer->addEdge(originalVertex(u), originalVertex(v));
+        }
+        writer->endPostman(static_cast<long long>(route.size()));
+        totalCost += static_cast<long long>(route.size());
+    }
+    cout << "Ant colony longest route: " << tour.longest << ", lower bound: " << bound.maxRoute << endl;
+    cout << "Gap: " << optimalityGap(tour.longest, bound.maxRoute) * 100 << "%" << endl;
+
+    if (writer->isOpen() && writer->finish(totalCost)) {
+        cout << "Results saved to " << outputPath << endl;
+    } else {
+        cerr << "Unable to open file for writing." << endl;
+    }
+}
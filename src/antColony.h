@@ -0,0 +1,66 @@
+#ifndef ANT_COLONY_H
+#define ANT_COLONY_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @file antColony.h
+ * @brief Ant colony optimisation of the k-postman tour (min-max route cost, unit weights).
+ *
+ * An ant builds all k routes at once: the postman with the cheapest route so far moves
+ * next, over an unserved edge at its vertex chosen with probability proportional to
+ * pheromone * (unserved edges at the far end)^2, or along a shortest path to the nearest
+ * vertex that still has one. Postmen are given connected components with allocatePostmen,
+ * as planPostmenRoutes does, and never leave their own: a postman whose component is
+ * finished moves on to its next component (only with fewer postmen than components) or
+ * stops. The choice looks at no more
+ * than candidateLimit unserved edges, so a step costs the same on dense and sparse graphs.
+ *
+ * Pheromone is a flat float array indexed by edge ID and direction (2 * id + dir).
+ * The ants of one iteration run in parallel and only read it; the update (evaporation,
+ * deposit of the iteration best, clamping to [minPheromone, maxPheromone]) is applied
+ * once per iteration. Every ant draws from its own generator seeded from (seed,
+ * iteration, ant), so the result does not depend on the number of threads.
+ */
+class AntColony {
+public:
+    static constexpr int candidateLimit = 16;
+    static constexpr float evaporation = 0.1f;
+    static constexpr float minPheromone = 0.01f;
+    static constexpr float maxPheromone = 1.0f;
+
+    /// A solution: the (from, to) steps of every postman and the cost of the longest route.
+    struct Tour {
+        std::vector<std::vector<std::pair<int, int>>> routes;
+        long long longest = -1;
+    };
+
+    AntColony(int vertices, const std::vector<std::pair<int, int>>& edges);
+
+    Tour solve(int postmen, int iterations, int ants, unsigned threads, uint32_t seed);
+
+    int getEdges() const { return static_cast<int>(edgeU.size()); }
+    /// Edge IDs of every connected component with edges.
+    const std::vector<std::vector<int>>& getComponents() const { return componentEdges; }
+
+private:
+    struct Scratch;
+
+    void construct(const std::vector<std::vector<int>>& homes, uint32_t seed, Scratch& scratch, Tour& tour,
+                   std::vector<int>& served) const;
+    int unservedVertex(int component, const Scratch& scratch) const;
+    bool walkToUnserved(int u, Scratch& scratch, std::vector<std::pair<int, int>>& route) const;
+
+    int vertices;
+    std::vector<int> edgeU;
+    std::vector<int> edgeV;
+    std::vector<int> offset;                      ///< Incident edges of u are slots [offset[u], offset[u + 1]).
+    std::vector<std::pair<int, int>> incident;    ///< (neighbour, edge ID) per slot.
+    std::vector<int> edgeSlot;                    ///< Slot of 2 * edge ID + dir in incident.
+    std::vector<float> pheromone;                 ///< 2 * edge ID + (0 from edgeU, 1 from edgeV).
+    std::vector<std::vector<int>> componentEdges; ///< Edge IDs per connected component.
+};
+
+#endif // ANT_COLONY_H
@@ -0,0 +1,356 @@
+#include "binaryFormat.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace std;
+
+static const uint8_t routeMagic[4] = {'C', 'P', 'R', 'T'};
+static const uint8_t routeVersion = 1;
+static const uint8_t graphMagic[4] = {'C', 'P', 'G', 'R'};
+static const uint8_t graphVersion = 1;
+
+/**
+ * @file binaryFormat.cpp
+ * @brief Updates a CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) with more bytes.
+ *
+ * @param crc The CRC of the bytes so far (0 for none).
+ * @param data The next bytes.
+ * @param size The number of bytes.
+ * @return The CRC of all bytes including data.
+ */
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size) {
+    static const array<uint32_t, 256> table = []() {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint8_t ByteReader::byte() {
+    if (pos >= size) {
+        throw runtime_error("Truncated binary file.");
+    }
+    return data[pos++];
+}
+
+uint64_t ByteReader::varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b = byte();
+        value |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return value;
+        }
+    }
+    throw runtime_error("Malformed varint in binary file.");
+}
+
+uint32_t ByteReader::u32() {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(byte()) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Reads a whole file into memory.
+ *
+ * @throws std::runtime_error If the file cannot be opened.
+ */
+vector<uint8_t> readWholeFile(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file) {
+        throw runtime_error("Could not open file " + path);
+    }
+    return vector<uint8_t>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+CompactRouteWriter::CompactRouteWriter(const string& path) : file(path) {
+    emit(routeMagic, sizeof(routeMagic));
+    emitByte(routeVersion);
+}
+
+void CompactRouteWriter::emit(const uint8_t* data, size_t size) {
+    crc = crc32Update(crc, data, size);
+    file.write(reinterpret_cast<const char*>(data), size);
+}
+
+void CompactRouteWriter::emitVarint(uint64_t value) {
+    uint8_t bytes[10];
+    emit(bytes, encodeVarint(value, bytes));
+}
+
+void CompactRouteWriter::closeWalk() {
+    if (inWalk) {
+        emitVarint(0);
+        inWalk = false;
+    }
+}
+
+void CompactRouteWriter::beginPostman() {
+    emitByte('P');
+    inWalk = false;
+    postmen++;
+}
+
+/**
+ * @brief Appends an edge to the current postman.
+ *
+ * Extends the current walk when u is where the previous edge ended, otherwise starts a new walk.
+ */
+void CompactRouteWriter::addEdge(int u, int v) {
+    if (!inWalk || lastVertex != u) {
+        closeWalk();
+        emitVarint(static_cast<uint64_t>(u) + 1);
+        inWalk = true;
+        lastVertex = u;
+    }
+    emitVarint(zigzagEncode(static_cast<int64_t>(v) - lastVertex) + 1);
+    lastVertex = v;
+}
+
+void CompactRouteWriter::endPostman(long long cost) {
+    closeWalk();
+    emitVarint(0);
+    emitVarint(zigzagEncode(cost));
+}
+
+void CompactRouteWriter::endPostman(double cost) {
+    endPostman(static_cast<long long>(llround(cost)));
+}
+
+bool CompactRouteWriter::writeTrailer(bool hasTotal, long long totalCost) {
+    emitByte('E');
+    emitVarint(static_cast<uint64_t>(postmen));
+    emitByte(hasTotal ? 1 : 0);
+    if (hasTotal) {
+        emitVarint(zigzagEncode(totalCost));
+    }
+    uint8_t checksum[4];
+    for (int i = 0; i < 4; ++i) {
+        checksum[i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+    file.write(reinterpret_cast<const char*>(checksum), sizeof(checksum));
+    return file.close();
+}
+
+bool CompactRouteWriter::finish() {
+    return writeTrailer(false, 0);
+}
+
+bool CompactRouteWriter::finish(long long totalCost) {
+    return writeTrailer(true, totalCost);
+}
+
+/**
+ * @brief Checks whether a file starts with the compact route container magic.
+ */
+bool isCompactRoutes(const string& path) {
+    ifstream file(path, ios::binary);
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    return file && equal(magic, magic + 4, routeMagic);
+}
+
+/**
+ * @brief Reads a compact route container.
+ *
+ * @param path The .cpr file to read.
+ * @return The decoded routes and costs.
+ *
+ * @throws std::runtime_error If the file cannot be opened, is truncated, has an unknown
+ *         version or its checksum does not match.
+ */
+CompactSolution readCompactRoutes(const string& path) {
+    vector<uint8_t> bytes = readWholeFile(path);
+    if (bytes.size() < 4 + 1 + 4 || !equal(bytes.begin(), bytes.begin() + 4, routeMagic)) {
+        throw runtime_error("Not a compact route file: " + path);
+    }
+    ByteReader in(bytes.data(), bytes.size());
+    for (int i = 0; i < 4; ++i) {
+        in.byte();
+    }
+    if (in.byte() != routeVersion) {
+        throw runtime_error("Unsupported compact route file version: " + path);
+    }
+
+    CompactSolution solution;
+    while (true) {
+        uint8_t tag = in.byte();
+        if (tag == 'E') {
+            break;
+        }
+        if (tag != 'P') {
+            throw runtime_error("Corrupt compact route file: " + path);
+        }
+        CompactRoute route;
+        while (uint64_t first = in.varint()) {
+            vector<int> walk{static_cast<int>(first - 1)};
+            while (uint64_t step = in.varint()) {
+                walk.push_back(static_cast<int>(walk.back() + zigzagDecode(step - 1)));
+            }
+            route.walks.push_back(move(walk));
+        }
+        route.cost = in.zigzag();
+        solution.postmen.push_back(move(route));
+    }
+    uint64_t postmen = in.varint();
+    solution.hasTotalCost = in.byte() != 0;
+    if (solution.hasTotalCost) {
+        solution.totalCost = in.zigzag();
+    }
+    size_t covered = in.position();
+    uint32_t stored = in.u32();
+    if (postmen != solution.postmen.size() || stored != crc32Update(0, bytes.data(), covered)) {
+        throw runtime_error("Checksum mismatch in compact route file: " + path);
+    }
+    return solution;
+}
+
+/**
+ * @brief Checks whether a file starts with the binary graph magic.
+ */
+bool isBinaryGraph(const string& path) {
+    ifstream file(path, ios::binary);
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    return file && equal(magic, magic + 4, graphMagic);
+}
+
+/**
+ * @brief Encodes a graph in the binary graph format.
+ *
+ * Edges are normalized to u < v, sorted and deduplicated before encoding.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The undirected edges.
+ * @return The encoded bytes, checksum included.
+ */
+vector<uint8_t> encodeBinaryGraph(int vertices, vector<pair<int, int>> edges) {
+    for (auto& [u, v] : edges) {
+        if (u > v) swap(u, v);
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    vector<uint8_t> out(graphMagic, graphMagic + 4);
+    out.reserve(16 + 3 * edges.size());
+    out.push_back(graphVersion);
+    uint8_t bytes[32];
+    size_t n = encodeVarint(static_cast<uint64_t>(vertices), bytes);
+    n += encodeVarint(edges.size(), bytes + n);
+    out.insert(out.end(), bytes, bytes + n);
+
+    int previousU = 0, previousV = 0;
+    bool first = true;
+    for (const auto& [u, v] : edges) {
+        n = encodeVarint(static_cast<uint64_t>(u - previousU), bytes);
+        int dv = (first || u != previousU) ? v - u - 1 : v - previousV - 1;
+        n += encodeVarint(static_cast<uint64_t>(dv), bytes + n);
+        out.insert(out.end(), bytes, bytes + n);
+        previousU = u;
+        previousV = v;
+        first = false;
+    }
+    uint32_t crc = crc32Update(0, out.data(), out.size());
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(crc >> (8 * i)));
+    }
+    return out;
+}
+
+/**
+ * @brief Decodes a graph in the binary graph format.
+ *
+ * @param data The encoded bytes.
+ * @param size The number of bytes.
+ * @param source Names the bytes in error messages.
+ * @param vertices Receives the number of vertices.
+ * @param edges Receives the edges as (u, v) with u < v.
+ *
+ * @throws std::runtime_error If the bytes are truncated, have an unknown version, contain an
+ *         out-of-range vertex or the checksum does not match.
+ */
+void decodeBinaryGraph(const uint8_t* data, size_t size, const string& source, int& vertices, vector<pair<int, int>>& edges) {
+    if (size < 4 + 1 + 4 || !equal(data, data + 4, graphMagic)) {
+        throw runtime_error("Not a binary graph file: " + source);
+    }
+    ByteReader in(data, size);
+    for (int i = 0; i < 4; ++i) {
+        in.byte();
+    }
+    if (in.byte() != graphVersion) {
+        throw runtime_error("Unsupported binary graph version: " + source);
+    }
+    vertices = static_cast<int>(in.varint());
+    uint64_t count = in.varint();
+    edges.clear();
+    edges.reserve(count);
+    int64_t u = 0, v = 0;
+    for (uint64_t e = 0; e < count; ++e) {
+        uint64_t du = in.varint();
+        uint64_t dv = in.varint();
+        if (du != 0 || e == 0) {
+            u += static_cast<int64_t>(du);
+            v = u + 1 + static_cast<int64_t>(dv);
+        } else {
+            v += 1 + static_cast<int64_t>(dv);
+        }
+        if (v >= vertices) {
+            throw runtime_error("Invalid edge: vertex out of bounds.");
+        }
+        edges.emplace_back(static_cast<int>(u), static_cast<int>(v));
+    }
+    size_t covered = in.position();
+    if (in.u32() != crc32Update(0, data, covered)) {
+        throw runtime_error("Checksum mismatch in binary graph file: " + source);
+    }
+}
+
+/**
+ * @brief Writes a graph in the binary graph format.
+ *
+ * @param path The .cpg file to write.
+ * @param vertices The number of vertices.
+ * @param edges The undirected edges (see encodeBinaryGraph).
+ * @return false if the file could not be written.
+ */
+bool writeBinaryGraph(const string& path, int vertices, vector<pair<int, int>> edges) {
+    BufferedFile file(path);
+    if (!file.isOpen()) {
+        return false;
+    }
+    vector<uint8_t> bytes = encodeBinaryGraph(vertices, move(edges));
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return file.close();
+}
+
+/**
+ * @brief Reads a graph in the binary graph format.
+ *
+ * @param path The .cpg file to read.
+ * @param vertices Receives the number of vertices.
+ * @param edges Receives the edges as (u, v) with u < v.
+ *
+ * @throws std::runtime_error If the file cannot be opened or does not decode (see decodeBinaryGraph).
+ */
+void readBinaryGraph(const string& path, int& vertices, vector<pair<int, int>>& edges) {
+    vector<uint8_t> bytes = readWholeFile(path);
+    decodeBinaryGraph(bytes.data(), bytes.size(), path, vertices, edges);
+}
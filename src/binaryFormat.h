@@ -0,0 +1,129 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "resultWriter.h"
+
+/**
+ * @file binaryFormat.h
+ * @brief Varint/CRC helpers and the compact route container (.cpr).
+ *
+ * Compact route container, version 1:
+ * @code
+ * "CPRT" u8:version
+ * per postman:  'P' walk* varint:0 zigzag:cost
+ *   walk:       varint:(first vertex + 1) varint:(zigzag(delta) + 1)* varint:0
+ * trailer:      'E' varint:postmen u8:hasTotal [zigzag:totalCost] u32le:crc32
+ * @endcode
+ * A walk is a maximal run of route edges where each edge starts at the vertex the
+ * previous one ended at, stored as its vertex sequence with delta-coded vertices.
+ * The CRC-32 covers every byte before it.
+ *
+ * Binary graph (.cpg), version 1:
+ * @code
+ * "CPGR" u8:version varint:vertices varint:edges edge* u32le:crc32
+ *   edge:       varint:(u - previous u) varint:(new u ? v - u - 1 : v - previous v - 1)
+ * @endcode
+ * Edges are stored once each as (u, v) with u < v, sorted by (u, v). "new u" holds for
+ * the first edge and whenever u differs from the previous edge's u.
+ */
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, std::size_t size);
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/// Appends value as a LEB128 varint to out and returns the number of bytes written (at most 10).
+inline std::size_t encodeVarint(uint64_t value, uint8_t* out) {
+    std::size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+/**
+ * @brief Sequential reader over an in-memory byte buffer.
+ *
+ * Every read throws std::runtime_error when it would run past the end.
+ */
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, std::size_t size) : data(data), size(size) {}
+
+    uint8_t byte();
+    uint64_t varint();
+    int64_t zigzag() { return zigzagDecode(varint()); }
+    uint32_t u32();
+    std::size_t position() const { return pos; }
+
+private:
+    const uint8_t* data;
+    std::size_t size;
+    std::size_t pos = 0;
+};
+
+std::vector<uint8_t> readWholeFile(const std::string& path);
+
+/**
+ * @brief RouteWriter producing the compact route container.
+ */
+class CompactRouteWriter : public RouteWriter {
+public:
+    explicit CompactRouteWriter(const std::string& path);
+
+    bool isOpen() const override { return file.isOpen(); }
+    void beginPostman() override;
+    void addEdge(int u, int v) override;
+    void endPostman(long long cost) override;
+    void endPostman(double cost) override;
+    bool finish() override;
+    bool finish(long long totalCost) override;
+
+private:
+    void emit(const uint8_t* data, std::size_t size);
+    void emitByte(uint8_t value) { emit(&value, 1); }
+    void emitVarint(uint64_t value);
+    void closeWalk();
+    bool writeTrailer(bool hasTotal, long long totalCost);
+
+    BufferedFile file;
+    uint32_t crc = 0;
+    long long postmen = 0;
+    bool inWalk = false;
+    int lastVertex = 0;
+};
+
+/// A postman's route as decoded from a compact container: a list of vertex walks and its cost.
+struct CompactRoute {
+    std::vector<std::vector<int>> walks;
+    long long cost = 0;
+};
+
+struct CompactSolution {
+    std::vector<CompactRoute> postmen;
+    bool hasTotalCost = false;
+    long long totalCost = 0;
+};
+
+bool isCompactRoutes(const std::string& path);
+CompactSolution readCompactRoutes(const std::string& path);
+
+bool isBinaryGraph(const std::string& path);
+std::vector<uint8_t> encodeBinaryGraph(int vertices, std::vector<std::pair<int, int>> edges);
+void decodeBinaryGraph(const uint8_t* data, std::size_t size, const std::string& source, int& vertices,
+                       std::vector<std::pair<int, int>>& edges);
+bool writeBinaryGraph(const std::string& path, int vertices, std::vector<std::pair<int, int>> edges);
+void readBinaryGraph(const std::string& path, int& vertices, std::vector<std::pair<int, int>>& edges);
+
+#endif // BINARY_FORMAT_H
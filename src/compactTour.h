@@ -0,0 +1,116 @@
+#ifndef COMPACT_TOUR_H
+#define COMPACT_TOUR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "adjacency.h"
+
+class DistanceTable;
+
+/**
+ * @file compactTour.h
+ * @brief Postman routes kept as token ranges of compressed closed walks until they are written.
+ *
+ * A closed walk is a stream of 4-byte tokens: a step over one edge of the graph, by the
+ * edge's ID and direction, or a reference to a shortest path between two vertices that
+ * records only its ends and cost. Routes are ranges of tokens, so splitting and balancing
+ * work on prefix costs and no route is copied out of the walk. A walk therefore takes 4
+ * bytes per required or repeated edge, 4 per edge and vertex for the edge IDs and 16 per
+ * deadhead path, however long the paths are. The paths are expanded one route at a time
+ * while the result is written (see Graph::expandRoute), from the walk's DistanceTable if
+ * one was built, otherwise from the contraction hierarchy or a shortest path tree.
+ */
+
+/// A shortest path walked as deadhead, by its ends and cost.
+struct PathRef {
+    int from;
+    int to;
+    int cost;
+};
+
+/// One closed walk in the vertices of the graph it was solved on.
+struct CompactTour {
+    static constexpr uint32_t pathBit = 1u << 31;
+
+    /// Edge e (edge << 1 | reversed) or path p (pathBit | p); an edge token is walked from its
+    /// smaller end unless reversed.
+    std::vector<uint32_t> tokens;
+    std::vector<int> firstEdge{0};  ///< Edges firstEdge[u] .. firstEdge[u + 1] - 1 run from u to a larger vertex.
+    std::vector<int> edgeTo;        ///< The larger end of every edge.
+    std::vector<PathRef> paths;
+    std::vector<int> globalIds;     ///< Vertex of the solved graph for every vertex of the walk, empty if the same.
+    std::shared_ptr<const DistanceTable> table;  ///< Distances the paths are expanded from, if one was built.
+
+    /// Numbers the edges (u, v), u < v, of a graph in increasing order.
+    void numberEdges(const AdjacencyIndex& adjacency, int vertices) {
+        firstEdge.assign(1, 0);
+        edgeTo.clear();
+        edgeTo.reserve(adjacency.edgeCount());
+        for (int u = 0; u < vertices; ++u) {
+            adjacency.forEachNeighbour(u, [&](int v) {
+                if (u < v) {
+                    edgeTo.push_back(v);
+                }
+            });
+            firstEdge.push_back(static_cast<int>(edgeTo.size()));
+        }
+    }
+
+    /// Appends the step u -> v over their edge, which must have been numbered.
+    void addStep(int u, int v) {
+        int low = std::min(u, v);
+        int high = std::max(u, v);
+        auto it = std::lower_bound(edgeTo.begin() + firstEdge[low], edgeTo.begin() + firstEdge[low + 1], high);
+        tokens.push_back(static_cast<uint32_t>(it - edgeTo.begin()) << 1 | (u > v));
+    }
+
+    void addPath(int from, int to, int cost) {
+        tokens.push_back(pathBit | static_cast<uint32_t>(paths.size()));
+        paths.push_back({from, to, cost});
+    }
+
+    bool isPath(int k) const { return (tokens[k] & pathBit) != 0; }
+    const PathRef& path(int k) const { return paths[tokens[k] & ~pathBit]; }
+    int edgeOf(int k) const { return static_cast<int>(tokens[k] >> 1); }
+    /// Cost of token k; every edge of a Graph has weight 1 (Graph::addEdge).
+    int cost(int k) const { return isPath(k) ? path(k).cost : 1; }
+
+    /// The ends of edge token k in walking order.
+    std::pair<int, int> step(int k) const {
+        int edge = edgeOf(k);
+        int low = static_cast<int>(std::upper_bound(firstEdge.begin(), firstEdge.end(), edge) - firstEdge.begin()) - 1;
+        return (tokens[k] & 1) ? std::make_pair(edgeTo[edge], low) : std::make_pair(low, edgeTo[edge]);
+    }
+
+    int size() const { return static_cast<int>(tokens.size()); }
+};
+
+/// Tokens [begin, end) of walk tour.
+struct TokenRange {
+    int tour;
+    int begin;
+    int end;
+};
+
+struct CompactRoutes {
+    std::vector<CompactTour> tours;               ///< One closed walk per connected component.
+    std::vector<std::vector<TokenRange>> routes;  ///< The ranges of every postman, in order.
+
+    /**
+     * @brief Returns the cost of postman i's route.
+     */
+    long long cost(int i) const {
+        long long total = 0;
+        for (const TokenRange& range : routes[i]) {
+            for (int t = range.begin; t < range.end; ++t) {
+                total += tours[range.tour].cost(t);
+            }
+        }
+        return total;
+    }
+};
+
+#endif // COMPACT_TOUR_H
@@ -0,0 +1,538 @@
+#include "contractionHierarchy.h"
+#include "binaryFormat.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+using namespace std;
+
+static const uint8_t hierarchyMagic[4] = {'C', 'P', 'C', 'H'};
+static const uint8_t hierarchyVersion = 1;
+static const long long unreachable = numeric_limits<long long>::max();
+
+/// Vertices settled by one witness search before it gives up and a shortcut is added.
+static const int witnessSettleLimit = 500;
+
+/// The same limit while only estimating priorities, which happens far more often.
+static const int estimateSettleLimit = 40;
+
+/// Contraction stops once the cheapest remaining vertex has more neighbours than this; the
+/// remaining core keeps all its arcs and queries search it like plain bidirectional Dijkstra.
+static const size_t coreDegree = 64;
+
+/// Degree above which a vertex's priority assumes all neighbour pairs need a shortcut
+/// instead of running witness searches, so hubs are contracted late and cheaply.
+static const size_t estimateDegree = 32;
+
+/**
+ * @file contractionHierarchy.cpp
+ * @brief Returns the edges as (u, v, weight) with u < v, sorted, without loops and keeping
+ *        the lightest of parallel edges.
+ */
+static vector<WeightedEdge> normalizeEdges(vector<WeightedEdge> edges) {
+    for (auto& e : edges) {
+        if (e.u > e.v) swap(e.u, e.v);
+    }
+    edges.erase(remove_if(edges.begin(), edges.end(), [](const WeightedEdge& e) { return e.u == e.v; }), edges.end());
+    sort(edges.begin(), edges.end(), [](const WeightedEdge& a, const WeightedEdge& b) {
+        return tie(a.u, a.v, a.weight) < tie(b.u, b.v, b.weight);
+    });
+    edges.erase(unique(edges.begin(), edges.end(), [](const WeightedEdge& a, const WeightedEdge& b) {
+        return a.u == b.u && a.v == b.v;
+    }), edges.end());
+    return edges;
+}
+
+/**
+ * @brief Computes the CRC-32 identifying a graph, independent of edge order and direction.
+ */
+uint32_t ContractionHierarchy::fingerprint(int vertices, const vector<WeightedEdge>& edges) {
+    uint8_t bytes[32];
+    uint32_t crc = crc32Update(0, bytes, encodeVarint(static_cast<uint64_t>(vertices), bytes));
+    for (const auto& e : normalizeEdges(edges)) {
+        size_t n = encodeVarint(static_cast<uint64_t>(e.u), bytes);
+        n += encodeVarint(static_cast<uint64_t>(e.v), bytes + n);
+        n += encodeVarint(static_cast<uint64_t>(e.weight), bytes + n);
+        crc = crc32Update(crc, bytes, n);
+    }
+    return crc;
+}
+
+namespace {
+
+using Arc = ContractionHierarchy::Arc;
+
+/// The remaining (not yet contracted) graph during preprocessing.
+class Contractor {
+public:
+    Contractor(int vertices, const vector<WeightedEdge>& edges)
+        : adj(vertices), dist(vertices, unreachable), contractedNeighbours(vertices, 0), level(vertices, 0) {
+        for (const auto& e : edges) {
+            adj[e.u].push_back({e.v, e.weight, -1});
+            adj[e.v].push_back({e.u, e.weight, -1});
+        }
+    }
+
+    /**
+     * @brief Importance of v: shortcuts contracting it would add minus the arcs it removes,
+     *        plus its contracted neighbours and its level in the hierarchy so far.
+     */
+    int priority(int v) {
+        return contract(v, false) - static_cast<int>(adj[v].size()) + contractedNeighbours[v] + level[v];
+    }
+
+    /// Contracts v and returns its arcs, which all lead to vertices contracted later.
+    vector<Arc> contractVertex(int v) {
+        contract(v, true);
+        for (const Arc& arc : adj[v]) {
+            auto& list = adj[arc.to];
+            list.erase(find_if(list.begin(), list.end(), [v](const Arc& a) { return a.to == v; }));
+            contractedNeighbours[arc.to]++;
+            level[arc.to] = max(level[arc.to], level[v] + 1);
+        }
+        return move(adj[v]);
+    }
+
+    const vector<Arc>& arcsOf(int v) const { return adj[v]; }
+
+private:
+    /**
+     * @brief Counts (and with apply adds) the shortcuts needed between the neighbours of v.
+     */
+    int contract(int v, bool apply) {
+        if (!apply && adj[v].size() > estimateDegree) {
+            return static_cast<int>(adj[v].size() * (adj[v].size() - 1) / 2);
+        }
+        const vector<Arc> neighbours = adj[v];
+        int needed = 0;
+        for (size_t i = 0; i + 1 < neighbours.size(); ++i) {
+            long long limit = 0;
+            for (size_t j = i + 1; j < neighbours.size(); ++j) {
+                limit = max(limit, static_cast<long long>(neighbours[i].weight) + neighbours[j].weight);
+            }
+            witnessSearch(neighbours[i].to, v, limit, apply ? witnessSettleLimit : estimateSettleLimit);
+            for (size_t j = i + 1; j < neighbours.size(); ++j) {
+                long long viaV = static_cast<long long>(neighbours[i].weight) + neighbours[j].weight;
+                if (dist[neighbours[j].to] > viaV) {
+                    needed++;
+                    if (apply) {
+                        addShortcut(neighbours[i].to, neighbours[j].to, static_cast<int>(viaV), v);
+                    }
+                }
+            }
+            clearSearch();
+        }
+        return needed;
+    }
+
+    /// Dijkstra from source that avoids skip, stops beyond limit and after settleLimit vertices.
+    void witnessSearch(int source, int skip, long long limit, int settleLimit) {
+        dist[source] = 0;
+        touched.push_back(source);
+        heap.emplace_back(0, source);
+        int settled = 0;
+        while (!heap.empty() && settled < settleLimit) {
+            pop_heap(heap.begin(), heap.end(), greater<>());
+            auto [d, u] = heap.back();
+            heap.pop_back();
+            if (d > dist[u]) continue;
+            if (d > limit) break;
+            settled++;
+            for (const Arc& arc : adj[u]) {
+                if (arc.to == skip) continue;
+                long long nd = d + arc.weight;
+                if (nd < dist[arc.to]) {
+                    if (dist[arc.to] == unreachable) touched.push_back(arc.to);
+                    dist[arc.to] = nd;
+                    heap.emplace_back(nd, arc.to);
+                    push_heap(heap.begin(), heap.end(), greater<>());
+                }
+            }
+        }
+    }
+
+    void clearSearch() {
+        for (int x : touched) dist[x] = unreachable;
+        touched.clear();
+        heap.clear();
+    }
+
+    void addShortcut(int a, int b, int weight, int middle) {
+        auto setArc = [&](int from, int to) {
+            for (Arc& arc : adj[from]) {
+                if (arc.to == to) {
+                    if (weight < arc.weight) {
+                        arc.weight = weight;
+                        arc.middle = middle;
+                    }
+                    return;
+                }
+            }
+            adj[from].push_back({to, weight, middle});
+        };
+        setArc(a, b);
+        setArc(b, a);
+    }
+
+    vector<vector<Arc>> adj;
+    vector<long long> dist;
+    vector<int> touched;
+    vector<pair<long long, int>> heap;
+    vector<int> contractedNeighbours;
+    vector<int> level;
+};
+
+} // namespace
+
+/**
+ * @brief Builds the hierarchy of an undirected graph.
+ *
+ * Vertices left in the core (see coreDegree) are ranked last and keep their arcs to
+ * each other in both directions.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The edges with non-negative weights; loops are ignored and of parallel edges
+ *              only the lightest is kept.
+ */
+ContractionHierarchy ContractionHierarchy::build(int vertices, const vector<WeightedEdge>& edges) {
+    vector<WeightedEdge> normalized = normalizeEdges(edges);
+    ContractionHierarchy ch;
+    ch.vertices = vertices;
+    ch.graphFingerprint = fingerprint(vertices, normalized);
+    ch.rank.assign(vertices, -1);
+
+    Contractor contractor(vertices, normalized);
+    vector<int> priority(vertices);
+    vector<pair<int, int>> queue;
+    auto push = [&](int v) {
+        queue.emplace_back(priority[v], v);
+        push_heap(queue.begin(), queue.end(), greater<>());
+    };
+    for (int v = 0; v < vertices; ++v) {
+        priority[v] = contractor.priority(v);
+        queue.emplace_back(priority[v], v);
+    }
+    make_heap(queue.begin(), queue.end(), greater<>());
+
+    vector<vector<Arc>> upward(vertices);
+    int next = 0;
+    while (!queue.empty()) {
+        pop_heap(queue.begin(), queue.end(), greater<>());
+        auto [stored, v] = queue.back();
+        queue.pop_back();
+        if (ch.rank[v] != -1 || stored != priority[v]) {
+            continue;  // contracted already, or superseded by a newer entry
+        }
+        // Lazy update: the priority may be stale, so recompute it and retry if v is no longer the minimum.
+        priority[v] = contractor.priority(v);
+        if (!queue.empty() && priority[v] > queue.front().first) {
+            push(v);
+            continue;
+        }
+        if (contractor.arcsOf(v).size() > coreDegree) {
+            break;
+        }
+        ch.rank[v] = next++;
+        upward[v] = contractor.contractVertex(v);
+        for (const Arc& arc : upward[v]) {
+            int updated = contractor.priority(arc.to);
+            if (updated != priority[arc.to]) {
+                priority[arc.to] = updated;
+                push(arc.to);
+            }
+        }
+    }
+
+    for (int v = 0; v < vertices; ++v) {
+        if (ch.rank[v] == -1) {
+            ch.rank[v] = next++;
+            upward[v] = contractor.arcsOf(v);
+        }
+    }
+
+    ch.firstArc.assign(vertices + 1, 0);
+    for (int v = 0; v < vertices; ++v) {
+        ch.firstArc[v + 1] = ch.firstArc[v] + static_cast<int>(upward[v].size());
+        ch.arcs.insert(ch.arcs.end(), upward[v].begin(), upward[v].end());
+    }
+    for (const Arc& arc : ch.arcs) {
+        ch.shortcuts += arc.middle >= 0 ? 1 : 0;
+    }
+    return ch;
+}
+
+/**
+ * @brief Bidirectional upward Dijkstra between s and t.
+ *
+ * Leaves both search trees in buffers for path unpacking; they are cleared at the start
+ * of the next search.
+ *
+ * @param meeting Receives the vertex where the shortest path peaks, -1 if t is unreachable.
+ * @return The distance, or unreachable.
+ */
+long long ContractionHierarchy::search(int s, int t, ChSearchBuffers& buffers, int& meeting) const {
+    for (int dir = 0; dir < 2; ++dir) {
+        if (buffers.dist[dir].size() != static_cast<size_t>(vertices)) {
+            buffers.dist[dir].assign(vertices, unreachable);
+            buffers.parent[dir].assign(vertices, -1);
+            buffers.parentArc[dir].assign(vertices, -1);
+            buffers.touched[dir].clear();
+        }
+        for (int x : buffers.touched[dir]) {
+            buffers.dist[dir][x] = unreachable;
+            buffers.parent[dir][x] = -1;
+            buffers.parentArc[dir][x] = -1;
+        }
+        buffers.touched[dir].clear();
+        buffers.heap[dir].clear();
+    }
+
+    int source[2] = {s, t};
+    for (int dir = 0; dir < 2; ++dir) {
+        buffers.dist[dir][source[dir]] = 0;
+        buffers.touched[dir].push_back(source[dir]);
+        buffers.heap[dir].emplace_back(0, source[dir]);
+    }
+
+    long long best = unreachable;
+    meeting = -1;
+    while (true) {
+        int dir = -1;
+        for (int d = 0; d < 2; ++d) {
+            auto& heap = buffers.heap[d];
+            if (!heap.empty() && heap.front().first < best &&
+                (dir == -1 || heap.front().first < buffers.heap[dir].front().first)) {
+                dir = d;
+            }
+        }
+        if (dir == -1) {
+            break;
+        }
+        auto& heap = buffers.heap[dir];
+        auto& dist = buffers.dist[dir];
+        pop_heap(heap.begin(), heap.end(), greater<>());
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        if (d > dist[u]) continue;
+
+        long long other = buffers.dist[1 - dir][u];
+        if (other != unreachable && d + other < best) {
+            best = d + other;
+            meeting = u;
+        }
+        // Stall-on-demand: if a higher vertex already reached offers a shorter way to u,
+        // u is not on a shortest up-path and need not be expanded.
+        bool stalled = false;
+        for (int a = firstArc[u]; a < firstArc[u + 1] && !stalled; ++a) {
+            long long via = dist[arcs[a].to];
+            stalled = via != unreachable && via + arcs[a].weight < d;
+        }
+        if (stalled) continue;
+
+        for (int a = firstArc[u]; a < firstArc[u + 1]; ++a) {
+            const Arc& arc = arcs[a];
+            long long nd = d + arc.weight;
+            if (nd < dist[arc.to]) {
+                if (dist[arc.to] == unreachable) buffers.touched[dir].push_back(arc.to);
+                dist[arc.to] = nd;
+                buffers.parent[dir][arc.to] = u;
+                buffers.parentArc[dir][arc.to] = a;
+                heap.emplace_back(nd, arc.to);
+                push_heap(heap.begin(), heap.end(), greater<>());
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Returns the length of a shortest path from s to t, or -1 if there is none.
+ */
+long long ContractionHierarchy::distance(int s, int t, ChSearchBuffers& buffers) const {
+    int meeting;
+    long long d = search(s, t, buffers, meeting);
+    return d == unreachable ? -1 : d;
+}
+
+/**
+ * @brief Returns the vertex bypassed by the arc between a and b, -1 for an original edge.
+ *
+ * The arc is stored at whichever endpoint was contracted first.
+ */
+int ContractionHierarchy::middleOf(int a, int b) const {
+    int low = rank[a] < rank[b] ? a : b;
+    int high = low == a ? b : a;
+    for (int i = firstArc[low]; i < firstArc[low + 1]; ++i) {
+        if (arcs[i].to == high) {
+            return arcs[i].middle;
+        }
+    }
+    throw runtime_error("Contraction hierarchy is missing an arc.");
+}
+
+/**
+ * @brief Appends a shortest path from s to t as (from, to) steps of the original graph.
+ *
+ * @return false if t cannot be reached from s (nothing is appended).
+ */
+bool ContractionHierarchy::appendPath(int s, int t, ChSearchBuffers& buffers, vector<pair<int, int>>& out) const {
+    if (s == t) {
+        return true;
+    }
+    int meeting;
+    if (search(s, t, buffers, meeting) == unreachable) {
+        return false;
+    }
+
+    // Upward arcs from s to the meeting vertex, then downward ones to t, as (from, to, arc).
+    vector<pair<int, int>>& chain = buffers.unpack;
+    chain.clear();
+    for (int x = meeting; x != s; x = buffers.parent[0][x]) {
+        chain.emplace_back(buffers.parent[0][x], x);
+    }
+    reverse(chain.begin(), chain.end());
+    for (int x = meeting; x != t; x = buffers.parent[1][x]) {
+        chain.emplace_back(x, buffers.parent[1][x]);
+    }
+
+    vector<pair<int, int>> stack;
+    for (const auto& [from, to] : chain) {
+        stack.emplace_back(from, to);
+        while (!stack.empty()) {
+            auto [x, y] = stack.back();
+            stack.pop_back();
+            int middle = middleOf(x, y);
+            if (middle < 0) {
+                out.emplace_back(x, y);
+            } else {
+                stack.emplace_back(middle, y);
+                stack.emplace_back(x, middle);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the hierarchy in the .ch format.
+ *
+ * @return false if the file could not be written.
+ */
+bool ContractionHierarchy::save(const string& path) const {
+    BufferedFile file(path, size_t(1) << 20);
+    if (!file.isOpen()) {
+        return false;
+    }
+    uint32_t crc = 0;
+    uint8_t bytes[32];
+    auto emit = [&](size_t size) {
+        crc = crc32Update(crc, bytes, size);
+        file.write(reinterpret_cast<const char*>(bytes), size);
+    };
+    auto emitU32 = [&](uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+        emit(4);
+    };
+    copy(hierarchyMagic, hierarchyMagic + 4, bytes);
+    bytes[4] = hierarchyVersion;
+    emit(5);
+    emit(encodeVarint(static_cast<uint64_t>(vertices), bytes));
+    emitU32(graphFingerprint);
+    for (int r : rank) {
+        emit(encodeVarint(static_cast<uint64_t>(r), bytes));
+    }
+    for (int v = 0; v < vertices; ++v) {
+        emit(encodeVarint(static_cast<uint64_t>(firstArc[v + 1] - firstArc[v]), bytes));
+        for (int a = firstArc[v]; a < firstArc[v + 1]; ++a) {
+            size_t n = encodeVarint(static_cast<uint64_t>(arcs[a].to), bytes);
+            n += encodeVarint(static_cast<uint64_t>(arcs[a].weight), bytes + n);
+            n += encodeVarint(static_cast<uint64_t>(arcs[a].middle + 1), bytes + n);
+            emit(n);
+        }
+    }
+    uint32_t checksum = crc;
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<uint8_t>(checksum >> (8 * i));
+    }
+    file.write(reinterpret_cast<const char*>(bytes), 4);
+    return file.close();
+}
+
+/**
+ * @brief Reads a hierarchy written by save.
+ *
+ * @return false if the file does not exist or is not a .ch file.
+ * @throws std::runtime_error If the file is truncated, has an unknown version, refers to
+ *         vertices out of range or its checksum does not match.
+ */
+bool ContractionHierarchy::load(const string& path, ContractionHierarchy& hierarchy) {
+    if (!ifstream(path, ios::binary)) {
+        return false;
+    }
+    vector<uint8_t> bytes = readWholeFile(path);
+    if (bytes.size() < 4 + 1 + 4 || !equal(bytes.begin(), bytes.begin() + 4, hierarchyMagic)) {
+        return false;
+    }
+    ByteReader in(bytes.data(), bytes.size());
+    for (int i = 0; i < 4; ++i) {
+        in.byte();
+    }
+    if (in.byte() != hierarchyVersion) {
+        throw runtime_error("Unsupported contraction hierarchy version: " + path);
+    }
+    ContractionHierarchy ch;
+    ch.vertices = static_cast<int>(in.varint());
+    ch.graphFingerprint = in.u32();
+    ch.rank.resize(ch.vertices);
+    for (int& r : ch.rank) {
+        r = static_cast<int>(in.varint());
+    }
+    ch.firstArc.assign(ch.vertices + 1, 0);
+    for (int v = 0; v < ch.vertices; ++v) {
+        uint64_t count = in.varint();
+        ch.firstArc[v + 1] = ch.firstArc[v] + static_cast<int>(count);
+        for (uint64_t a = 0; a < count; ++a) {
+            Arc arc;
+            arc.to = static_cast<int>(in.varint());
+            arc.weight = static_cast<int>(in.varint());
+            arc.middle = static_cast<int>(in.varint()) - 1;
+            if (arc.to >= ch.vertices || arc.middle >= ch.vertices) {
+                throw runtime_error("Invalid arc in contraction hierarchy: " + path);
+            }
+            ch.shortcuts += arc.middle >= 0 ? 1 : 0;
+            ch.arcs.push_back(arc);
+        }
+    }
+    size_t covered = in.position();
+    if (in.u32() != crc32Update(0, bytes.data(), covered)) {
+        throw runtime_error("Checksum mismatch in contraction hierarchy: " + path);
+    }
+    hierarchy = move(ch);
+    return true;
+}
+
+/**
+ * @brief ContractionHierarchy::distance between vertices of the viewing graph.
+ */
+long long HierarchyView::distance(int s, int t, ChSearchBuffers& buffers) const {
+    return hierarchy->distance(toGlobal(s), toGlobal(t), buffers);
+}
+
+/**
+ * @brief ContractionHierarchy::appendPath between vertices of the viewing graph.
+ */
+bool HierarchyView::appendPath(int s, int t, ChSearchBuffers& buffers, vector<pair<int, int>>& out) const {
+    size_t first = out.size();
+    if (!hierarchy->appendPath(toGlobal(s), toGlobal(t), buffers, out)) {
+        return false;
+    }
+    for (size_t i = first; i < out.size(); ++i) {
+        out[i] = {toLocal(out[i].first), toLocal(out[i].second)};
+    }
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @file contractionHierarchy.h
+ * @brief Contraction hierarchy over an undirected weighted graph for fast point-to-point queries.
+ *
+ * Vertices are contracted one by one in order of increasing importance (edge difference
+ * plus contracted neighbours, updated lazily). Contracting v adds a shortcut (a, b) for
+ * every pair of neighbours whose shortest path leads through v, unless a bounded witness
+ * search finds a path around v. Every vertex keeps only its arcs to more important
+ * vertices; a query is a bidirectional Dijkstra that only climbs, and shortcuts are
+ * unpacked through the vertex they bypass. Once only high-degree vertices remain (dense
+ * cores of non-planar graphs) contraction stops and the core is searched as it is.
+ *
+ * Serialized form (.ch), version 1:
+ * @code
+ * "CPCH" u8:version varint:vertices u32le:fingerprint varint:rank*
+ *   per vertex: varint:arcs (varint:to varint:weight varint:(middle + 1))*
+ * u32le:crc32
+ * @endcode
+ * The fingerprint is a CRC-32 of the graph the hierarchy was built from, so a hierarchy
+ * saved next to a graph file is rebuilt when the graph changes.
+ */
+
+struct WeightedEdge {
+    int u;
+    int v;
+    int weight;
+};
+
+/// Per-thread search state of ContractionHierarchy queries, sized on first use and reused.
+struct ChSearchBuffers {
+    std::vector<long long> dist[2];
+    std::vector<int> parent[2];
+    std::vector<int> parentArc[2];
+    std::vector<int> touched[2];
+    std::vector<std::pair<long long, int>> heap[2];
+    std::vector<std::pair<int, int>> unpack;
+};
+
+class ContractionHierarchy {
+public:
+    struct Arc {
+        int to;
+        int weight;
+        int middle;  ///< Vertex bypassed by this shortcut, -1 for an original edge.
+    };
+
+    static ContractionHierarchy build(int vertices, const std::vector<WeightedEdge>& edges);
+    static uint32_t fingerprint(int vertices, const std::vector<WeightedEdge>& edges);
+
+    bool save(const std::string& path) const;
+    static bool load(const std::string& path, ContractionHierarchy& hierarchy);
+
+    int getVertices() const { return vertices; }
+    uint32_t getFingerprint() const { return graphFingerprint; }
+    std::size_t shortcutCount() const { return shortcuts; }
+
+    long long distance(int s, int t, ChSearchBuffers& buffers) const;
+    bool appendPath(int s, int t, ChSearchBuffers& buffers, std::vector<std::pair<int, int>>& out) const;
+
+private:
+    long long search(int s, int t, ChSearchBuffers& buffers, int& meeting) const;
+    int middleOf(int a, int b) const;
+
+    int vertices = 0;
+    uint32_t graphFingerprint = 0;
+    std::size_t shortcuts = 0;
+    std::vector<int> rank;
+    std::vector<int> firstArc;  ///< Upward arcs of x are arcs[firstArc[x] .. firstArc[x + 1]).
+    std::vector<Arc> arcs;
+};
+
+/**
+ * @brief A hierarchy built for a larger graph, used from a graph cut out of it.
+ *
+ * toHierarchy maps the vertices of the graph using the view to hierarchy vertices and
+ * fromHierarchy maps back; both are empty when the numbering is the same.
+ */
+struct HierarchyView {
+    std::shared_ptr<const ContractionHierarchy> hierarchy;
+    std::vector<int> toHierarchy;
+    std::shared_ptr<const std::vector<int>> fromHierarchy;
+
+    explicit operator bool() const { return hierarchy != nullptr; }
+    int toGlobal(int v) const { return toHierarchy.empty() ? v : toHierarchy[v]; }
+    int toLocal(int v) const { return fromHierarchy ? (*fromHierarchy)[v] : v; }
+    long long distance(int s, int t, ChSearchBuffers& buffers) const;
+    bool appendPath(int s, int t, ChSearchBuffers& buffers, std::vector<std::pair<int, int>>& out) const;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
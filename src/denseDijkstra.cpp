@@ -0,0 +1,197 @@
+#include "denseDijkstra.h"
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const int unreached = numeric_limits<int>::max();
+
+/**
+ * @brief Returns the first index of the smallest key, or -1 if every key is unreached.
+ */
+int argminKey(const int* key, int n) {
+    int best = unreached;
+    int bestIndex = -1;
+    int i = 0;
+#if defined(__AVX2__)
+    if (n >= 8) {
+        __m256i minValue = _mm256_set1_epi32(unreached);
+        __m256i minIndex = _mm256_set1_epi32(-1);
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i step = _mm256_set1_epi32(8);
+        for (; i + 8 <= n; i += 8) {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + i));
+            __m256i less = _mm256_cmpgt_epi32(minValue, value);
+            minValue = _mm256_min_epi32(minValue, value);
+            minIndex = _mm256_blendv_epi8(minIndex, index, less);
+            index = _mm256_add_epi32(index, step);
+        }
+        alignas(32) int values[8];
+        alignas(32) int indices[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values), minValue);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(indices), minIndex);
+        for (int lane = 0; lane < 8; ++lane) {
+            if (values[lane] < best || (values[lane] == best && values[lane] != unreached && indices[lane] < bestIndex)) {
+                best = values[lane];
+                bestIndex = indices[lane];
+            }
+        }
+    }
+#elif defined(__SSE4_1__)
+    if (n >= 4) {
+        __m128i minValue = _mm_set1_epi32(unreached);
+        __m128i minIndex = _mm_set1_epi32(-1);
+        __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i step = _mm_set1_epi32(4);
+        for (; i + 4 <= n; i += 4) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + i));
+            __m128i less = _mm_cmpgt_epi32(minValue, value);
+            minValue = _mm_min_epi32(minValue, value);
+            minIndex = _mm_blendv_epi8(minIndex, index, less);
+            index = _mm_add_epi32(index, step);
+        }
+        alignas(16) int values[4];
+        alignas(16) int indices[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(values), minValue);
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), minIndex);
+        for (int lane = 0; lane < 4; ++lane) {
+            if (values[lane] < best || (values[lane] == best && values[lane] != unreached && indices[lane] < bestIndex)) {
+                best = values[lane];
+                bestIndex = indices[lane];
+            }
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (key[i] < best) {
+            best = key[i];
+            bestIndex = i;
+        }
+    }
+    return bestIndex;
+}
+
+/**
+ * @brief Relaxes every edge (u, v) of row, lowering dist, key and parent of v where shorter.
+ *
+ * Settled vertices need no mask: their distance is at most du, so du + w never beats it.
+ */
+void relaxRow(const int* row, int u, int du, int* dist, int* key, int* parent, int n) {
+    int v = 0;
+#if defined(__AVX2__)
+    const __m256i base = _mm256_set1_epi32(du);
+    const __m256i from = _mm256_set1_epi32(u);
+    const __m256i zero = _mm256_setzero_si256();
+    for (; v + 8 <= n; v += 8) {
+        __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + v));
+        __m256i edge = _mm256_cmpgt_epi32(weight, zero);
+        if (_mm256_testz_si256(edge, edge)) {
+            continue;
+        }
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dist + v));
+        __m256i candidate = _mm256_add_epi32(base, weight);
+        __m256i shorter = _mm256_and_si256(edge, _mm256_cmpgt_epi32(current, candidate));
+        if (_mm256_testz_si256(shorter, shorter)) {
+            continue;
+        }
+        __m256i oldKey = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + v));
+        __m256i oldParent = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(parent + v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dist + v), _mm256_blendv_epi8(current, candidate, shorter));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(key + v), _mm256_blendv_epi8(oldKey, candidate, shorter));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(parent + v), _mm256_blendv_epi8(oldParent, from, shorter));
+    }
+#elif defined(__SSE4_1__)
+    const __m128i base = _mm_set1_epi32(du);
+    const __m128i from = _mm_set1_epi32(u);
+    const __m128i zero = _mm_setzero_si128();
+    for (; v + 4 <= n; v += 4) {
+        __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + v));
+        __m128i edge = _mm_cmpgt_epi32(weight, zero);
+        if (_mm_testz_si128(edge, edge)) {
+            continue;
+        }
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dist + v));
+        __m128i candidate = _mm_add_epi32(base, weight);
+        __m128i shorter = _mm_and_si128(edge, _mm_cmpgt_epi32(current, candidate));
+        if (_mm_testz_si128(shorter, shorter)) {
+            continue;
+        }
+        __m128i oldKey = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + v));
+        __m128i oldParent = _mm_loadu_si128(reinterpret_cast<const __m128i*>(parent + v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dist + v), _mm_blendv_epi8(current, candidate, shorter));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(key + v), _mm_blendv_epi8(oldKey, candidate, shorter));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(parent + v), _mm_blendv_epi8(oldParent, from, shorter));
+    }
+#endif
+    for (; v < n; ++v) {
+        if (row[v] > 0 && du + row[v] < dist[v]) {
+            dist[v] = du + row[v];
+            key[v] = dist[v];
+            parent[v] = u;
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Tells whether a graph is dense enough for denseShortestPathTree.
+ *
+ * Path expansion usually settles a small part of the graph before reaching its target,
+ * which favours the heap; the linear scans only pay off on very dense graphs, and never
+ * in the scalar build.
+ */
+bool preferDenseDijkstra(int vertices, long long edges) {
+#if defined(__AVX2__) || defined(__SSE4_1__)
+    if (vertices < 2) {
+        return false;
+    }
+    double possible = static_cast<double>(vertices) * (vertices - 1) / 2.0;
+    return static_cast<double>(edges) / possible > denseDijkstraThreshold;
+#else
+    (void)vertices;
+    (void)edges;
+    return false;
+#endif
+}
+
+/**
+ * @brief Dijkstra's algorithm from start without a priority queue.
+ *
+ * key mirrors dist for unsettled vertices and is set to "unreached" once a vertex is
+ * settled, so the argmin only sees the frontier. Stops once target is settled (pass -1
+ * for the whole tree).
+ *
+ * @param start The starting vertex.
+ * @param target The vertex whose path is needed, or -1.
+ * @param adjMatrix The adjacency matrix; adjMatrix[u][v] > 0 is the weight of edge (u, v).
+ * @param vertices The number of vertices.
+ * @param dist Receives the distances (int max where not reached).
+ * @param key Scratch buffer.
+ * @param parent Receives the shortest path tree.
+ */
+void denseShortestPathTree(int start, int target, const vector<vector<int>>& adjMatrix, int vertices,
+                           vector<int>& dist, vector<int>& key, vector<int>& parent) {
+    dist.assign(vertices, unreached);
+    key.assign(vertices, unreached);
+    parent.assign(vertices, -1);
+    dist[start] = 0;
+    key[start] = 0;
+
+    while (true) {
+        int u = argminKey(key.data(), vertices);
+        if (u == -1) {
+            break;
+        }
+        key[u] = unreached;
+        if (u == target) {
+            break;
+        }
+        relaxRow(adjMatrix[u].data(), u, dist[u], dist.data(), key.data(), parent.data(), vertices);
+    }
+}
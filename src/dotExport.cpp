@@ -0,0 +1,139 @@
+#include "dotExport.h"
+#include "graph.h"
+#include "resultWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+struct GroupPair {
+    long long edges = 0;
+    int best = -1;            ///< Group with the most edges between the two ranges so far.
+    long long bestEdges = 0;
+    int current = -1;         ///< Group being counted; groups arrive one after another.
+    long long currentEdges = 0;
+
+    void add(int group) {
+        if (group != current) {
+            settle();
+            current = group;
+            currentEdges = 0;
+        }
+        currentEdges++;
+        edges++;
+    }
+
+    void settle() {
+        if (currentEdges > bestEdges) {
+            best = current;
+            bestEdges = currentEdges;
+        }
+    }
+};
+
+void writeColor(BufferedFile& file, int group) {
+    file.write(" [color=\"");
+    file.write(getColor(group));
+    file.put('"');
+}
+
+void writeEdge(BufferedFile& file, int u, int v, int group) {
+    file.write("  ");
+    file.writeNumber(static_cast<long long>(u));
+    file.write(" -- ");
+    file.writeNumber(static_cast<long long>(v));
+    writeColor(file, group);
+    file.write("];\n");
+}
+
+void writeSampled(BufferedFile& file, const vector<vector<pair<int, int>>>& groups, size_t stride) {
+    size_t index = 0;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        for (const auto& edge : groups[g]) {
+            if (index++ % stride == 0) {
+                writeEdge(file, edge.first, edge.second, static_cast<int>(g));
+            }
+        }
+    }
+}
+
+void writeAggregated(BufferedFile& file, int vertices, const vector<vector<pair<int, int>>>& groups, size_t maxEdges) {
+    // About ranges^2 / 2 pairs of ranges can appear, so this keeps the output within the budget.
+    long long ranges = max(1LL, min(static_cast<long long>(vertices),
+                                    static_cast<long long>(sqrt(2.0 * static_cast<double>(maxEdges)))));
+    auto rangeOf = [&](int v) { return static_cast<long long>(v) * ranges / vertices; };
+
+    unordered_map<uint64_t, GroupPair> pairs;
+    vector<long long> inner(ranges, 0);
+    for (size_t g = 0; g < groups.size(); ++g) {
+        for (const auto& edge : groups[g]) {
+            long long a = rangeOf(edge.first), b = rangeOf(edge.second);
+            if (a == b) {
+                inner[a]++;
+                continue;
+            }
+            if (a > b) swap(a, b);
+            pairs[static_cast<uint64_t>(a) * ranges + b].add(static_cast<int>(g));
+        }
+    }
+
+    for (long long r = 0; r < ranges; ++r) {
+        long long first = (r * vertices + ranges - 1) / ranges;
+        long long last = ((r + 1) * vertices + ranges - 1) / ranges - 1;
+        file.write("  ");
+        file.writeNumber(r);
+        file.write(" [label=\"");
+        file.writeNumber(first);
+        file.write("..");
+        file.writeNumber(last);
+        file.write("\\n");
+        file.writeNumber(inner[r]);
+        file.write(" inner\"];\n");
+    }
+
+    vector<pair<uint64_t, GroupPair>> ordered(pairs.begin(), pairs.end());
+    sort(ordered.begin(), ordered.end(), [](const auto& x, const auto& y) { return x.first < y.first; });
+    for (auto& [key, counts] : ordered) {
+        counts.settle();
+        file.write("  ");
+        file.writeNumber(static_cast<long long>(key / ranges));
+        file.write(" -- ");
+        file.writeNumber(static_cast<long long>(key % ranges));
+        writeColor(file, counts.best);
+        file.write(", label=\"");
+        file.writeNumber(counts.edges);
+        file.write("\", penwidth=");
+        file.writeNumber(1.0 + floor(log2(static_cast<double>(counts.edges))));
+        file.write("];\n");
+    }
+}
+
+} // namespace
+
+bool writeDot(const string& path, int vertices, const vector<vector<pair<int, int>>>& groups,
+              size_t maxEdges, DotDetail detail) {
+    BufferedFile file(path, size_t(1) << 20);
+    if (!file.isOpen()) {
+        return false;
+    }
+    size_t edges = 0;
+    for (const auto& group : groups) {
+        edges += group.size();
+    }
+    maxEdges = max<size_t>(maxEdges, 1);
+
+    file.write("graph G {\n");
+    if (edges <= maxEdges) {
+        writeSampled(file, groups, 1);
+    } else if (detail == DotDetail::Sample) {
+        writeSampled(file, groups, (edges + maxEdges - 1) / maxEdges);
+    } else {
+        writeAggregated(file, max(vertices, 1), groups, maxEdges);
+    }
+    file.write("}\n");
+    return file.close();
+}
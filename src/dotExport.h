@@ -0,0 +1,34 @@
+#ifndef DOT_EXPORT_H
+#define DOT_EXPORT_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "options.h"
+
+/**
+ * @file dotExport.h
+ * @brief Buffered Graphviz DOT export with a level-of-detail fallback for large graphs.
+ */
+
+/**
+ * @brief Writes edge groups to a DOT file, every group in its own color (see getColor).
+ *
+ * Up to maxEdges edges are written as they are. Larger inputs are reduced as selected by
+ * detail: Sample keeps every k-th edge, Aggregate merges vertices into consecutive ranges
+ * and draws one edge per pair of ranges, colored by the group with the most edges in it
+ * and labelled with the edge count.
+ *
+ * @param path The DOT file to write.
+ * @param vertices The number of vertices.
+ * @param groups The edges, one list per color (e.g. per postman).
+ * @param maxEdges The edge budget of the export.
+ * @param detail The reduction used above the budget.
+ * @return false if the file could not be written.
+ */
+bool writeDot(const std::string& path, int vertices,
+              const std::vector<std::vector<std::pair<int, int>>>& groups,
+              std::size_t maxEdges, DotDetail detail);
+
+#endif // DOT_EXPORT_H
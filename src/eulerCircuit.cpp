@@ -0,0 +1,229 @@
+#include "eulerCircuit.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+/**
+ * @file eulerCircuit.cpp
+ * @brief Groups the edge ends ("slots") by vertex.
+ *
+ * Edge e = (u, v) owns slot 2e at u and slot 2e + 1 at v. After the call the slots of
+ * vertex x are slots[offset[x] .. offset[x + 1]) in increasing edge order.
+ */
+static void buildIncidence(int vertices, const vector<pair<int, int>>& edges, vector<int>& offset, vector<int>& slots,
+                           vector<int>& fill) {
+    offset.assign(vertices + 1, 0);
+    for (const auto& [u, v] : edges) {
+        offset[u + 1]++;
+        offset[v + 1]++;
+    }
+    for (int x = 0; x < vertices; ++x) {
+        offset[x + 1] += offset[x];
+    }
+    slots.resize(2 * edges.size());
+    fill.assign(offset.begin(), offset.end() - 1);
+    for (size_t e = 0; e < edges.size(); ++e) {
+        slots[fill[edges[e].first]++] = static_cast<int>(2 * e);
+        slots[fill[edges[e].second]++] = static_cast<int>(2 * e + 1);
+    }
+}
+
+static inline int slotVertex(const vector<pair<int, int>>& edges, int slot) {
+    return (slot & 1) ? edges[slot >> 1].second : edges[slot >> 1].first;
+}
+
+/**
+ * @brief Builds an Euler circuit with Hierholzer's algorithm in O(V + E).
+ *
+ * Every vertex keeps a cursor into its incidence list, so each edge end is looked at once.
+ * If some degrees are odd the result still covers every reachable edge, but consecutive
+ * steps may not share a vertex.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The undirected edges.
+ * @param start The vertex the circuit starts and ends at.
+ * @return The circuit as (from, to) steps in traversal order.
+ */
+vector<pair<int, int>> eulerCircuitSerial(int vertices, const vector<pair<int, int>>& edges, int start) {
+    EulerScratch scratch;
+    vector<pair<int, int>> circuit;
+    circuit.reserve(edges.size());
+    eulerCircuitSerial(vertices, edges, start, scratch, [&circuit](int from, int to) { circuit.emplace_back(from, to); });
+    return circuit;
+}
+
+/**
+ * @brief eulerCircuitSerial handing the steps to emit and reusing the buffers in scratch.
+ *
+ * Hierholzer's algorithm finishes the circuit from its end, so the steps are emitted in the
+ * order they are finished, each reversed: that is the same circuit walked the other way.
+ */
+void eulerCircuitSerial(int vertices, const vector<pair<int, int>>& edges, int start,
+                        EulerScratch& scratch, const EulerStepSink& emit) {
+    vector<int>& offset = scratch.offset;
+    vector<int>& slots = scratch.slots;
+    buildIncidence(vertices, edges, offset, slots, scratch.fill);
+
+    vector<char>& used = scratch.used;
+    used.assign(edges.size(), 0);
+    vector<int>& cursor = scratch.cursor;
+    cursor.assign(offset.begin(), offset.end() - 1);
+    vector<pair<int, int>>& stack = scratch.stack;
+    stack.clear();
+
+    stack.emplace_back(start, -1);
+    while (!stack.empty()) {
+        int u = stack.back().first;
+        int& i = cursor[u];
+        while (i < offset[u + 1] && used[slots[i] >> 1]) {
+            ++i;
+        }
+        if (i < offset[u + 1]) {
+            int slot = slots[i++];
+            used[slot >> 1] = 1;
+            stack.emplace_back(slotVertex(edges, slot ^ 1), u);
+        } else {
+            auto [v, from] = stack.back();
+            stack.pop_back();
+            if (from != -1) {
+                emit(v, from);
+            }
+        }
+    }
+}
+
+static int findRoot(vector<int>& parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/**
+ * @brief Builds an Euler circuit with several threads.
+ *
+ * 1. At every vertex the incident edge ends are paired up (1st with 2nd, 3rd with 4th, ...).
+ *    Entering a vertex through one end of a pair means leaving through the other, so the
+ *    pairing splits the edges into edge-disjoint closed sub-circuits.
+ * 2. Threads walk these sub-circuits from different start edges in parallel, claiming each
+ *    edge with a compare-and-swap; a walk stops at an edge claimed by another walk.
+ * 3. The walk fragments are joined with a union-find into the sub-circuits of step 1.
+ * 4. A serial pass over the vertices splices any two different sub-circuits meeting at a
+ *    vertex into one by swapping the partners of two pairs.
+ * 5. The single remaining circuit is read off from the start vertex.
+ *
+ * Steps 1, 4 and 5 depend only on the edge order, so the result is the same for any number
+ * of threads. Every degree must be even; otherwise the serial builder is used. Step 5 needs
+ * only the pairing, so the other buffers are released before it.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The undirected edges.
+ * @param start The vertex the circuit starts and ends at.
+ * @param threads The number of worker threads.
+ * @return The circuit as (from, to) steps in traversal order.
+ */
+vector<pair<int, int>> eulerCircuitParallel(int vertices, const vector<pair<int, int>>& edges, int start, unsigned threads) {
+    EulerScratch scratch;
+    vector<pair<int, int>> circuit;
+    circuit.reserve(edges.size());
+    eulerCircuitParallel(vertices, edges, start, threads, scratch,
+                         [&circuit](int from, int to) { circuit.emplace_back(from, to); });
+    return circuit;
+}
+
+/**
+ * @brief eulerCircuitParallel handing the steps to emit; scratch is used only by the
+ *        serial fallback.
+ */
+void eulerCircuitParallel(int vertices, const vector<pair<int, int>>& edges, int start, unsigned threads,
+                          EulerScratch& scratch, const EulerStepSink& emit) {
+    vector<int> offset, slots, fill;
+    buildIncidence(vertices, edges, offset, slots, fill);
+    for (int x = 0; x < vertices; ++x) {
+        if ((offset[x + 1] - offset[x]) % 2 != 0) {
+            eulerCircuitSerial(vertices, edges, start, scratch, emit);
+            return;
+        }
+    }
+    if (edges.empty() || offset[start + 1] == offset[start]) {
+        return;
+    }
+
+    ThreadPool pool(threads);
+    size_t m = edges.size();
+
+    vector<int> mate(2 * m);
+    parallelFor(pool, slots.size() / 2, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            mate[slots[2 * i]] = slots[2 * i + 1];
+            mate[slots[2 * i + 1]] = slots[2 * i];
+        }
+    });
+
+    vector<atomic<int>> label(m);
+    for (auto& l : label) {
+        l.store(-1, memory_order_relaxed);
+    }
+    parallelFor(pool, m, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            int id = static_cast<int>(e);
+            int expected = -1;
+            if (!label[e].compare_exchange_strong(expected, id, memory_order_relaxed)) {
+                continue;
+            }
+            int slot = mate[2 * e + 1];
+            while (true) {
+                expected = -1;
+                if (!label[slot >> 1].compare_exchange_strong(expected, id, memory_order_relaxed)) {
+                    break;
+                }
+                slot = mate[slot ^ 1];
+            }
+        }
+    });
+
+    vector<int> parent(m);
+    for (size_t e = 0; e < m; ++e) {
+        parent[e] = static_cast<int>(e);
+    }
+    for (size_t slot = 0; slot < 2 * m; ++slot) {
+        int a = findRoot(parent, label[slot >> 1].load(memory_order_relaxed));
+        int b = findRoot(parent, label[mate[slot] >> 1].load(memory_order_relaxed));
+        if (a != b) {
+            parent[b] = a;
+        }
+    }
+
+    for (int x = 0; x < vertices; ++x) {
+        int first = offset[x];
+        for (int i = first + 2; i < offset[x + 1]; i += 2) {
+            int a = findRoot(parent, label[slots[first] >> 1].load(memory_order_relaxed));
+            int b = findRoot(parent, label[slots[i] >> 1].load(memory_order_relaxed));
+            if (a == b) {
+                continue;
+            }
+            int p = slots[first], q = mate[p];
+            int r = slots[i], t = mate[r];
+            mate[p] = t;
+            mate[t] = p;
+            mate[r] = q;
+            mate[q] = r;
+            parent[b] = a;
+        }
+    }
+
+    int first = slots[offset[start]];
+    for (vector<int>* buffer : {&offset, &slots, &fill, &parent}) {
+        vector<int>().swap(*buffer);
+    }
+    vector<atomic<int>>().swap(label);
+    int slot = first;
+    do {
+        emit(slotVertex(edges, slot), slotVertex(edges, slot ^ 1));
+        slot = mate[slot ^ 1];
+    } while (slot != first);
+}
@@ -0,0 +1,42 @@
+#ifndef EULER_CIRCUIT_H
+#define EULER_CIRCUIT_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <utility>
+
+/**
+ * @file eulerCircuit.h
+ * @brief Euler circuit builders over an undirected edge list.
+ *
+ * Both builders produce the walk as (from, to) steps in traversal order and accept
+ * parallel edges and loops. Only the edges reachable from the start vertex are walked.
+ * They either return the whole circuit or hand the steps one by one to a sink, so a
+ * caller that compresses the walk never holds it in full.
+ */
+
+/// Receives the steps of a circuit, (from, to), in traversal order.
+using EulerStepSink = std::function<void(int from, int to)>;
+
+/// Edge count from which Graph::findEulerCycle switches to the parallel builder.
+constexpr std::size_t parallelEulerThreshold = std::size_t(1) << 17;
+
+/// Scratch buffers of eulerCircuitSerial, kept between calls so repeated solves do not allocate.
+struct EulerScratch {
+    std::vector<int> offset;
+    std::vector<int> slots;
+    std::vector<int> fill;
+    std::vector<int> cursor;
+    std::vector<char> used;
+    std::vector<std::pair<int, int>> stack;
+};
+
+std::vector<std::pair<int, int>> eulerCircuitSerial(int vertices, const std::vector<std::pair<int, int>>& edges, int start);
+void eulerCircuitSerial(int vertices, const std::vector<std::pair<int, int>>& edges, int start,
+                        EulerScratch& scratch, const EulerStepSink& emit);
+std::vector<std::pair<int, int>> eulerCircuitParallel(int vertices, const std::vector<std::pair<int, int>>& edges, int start, unsigned threads);
+void eulerCircuitParallel(int vertices, const std::vector<std::pair<int, int>>& edges, int start, unsigned threads,
+                          EulerScratch& scratch, const EulerStepSink& emit);
+
+#endif // EULER_CIRCUIT_H
@@ -0,0 +1,92 @@
+#include "fitnessCache.h"
+
+using namespace std;
+
+FitnessCache::FitnessCache(size_t capacity) {
+    size_t perShard = 2;
+    while (perShard * shardCount < capacity) {
+        perShard *= 2;
+    }
+    slotMask = perShard - 1;
+    for (Shard& shard : shards) {
+        shard.slots.resize(perShard);
+    }
+}
+
+/**
+ * @brief Hashes the routes, vertex by vertex and with every route's length, into 64 bits.
+ *
+ * Vertices are taken two per 64-bit word into four independent multiply-rotate lanes, so
+ * the hash of a long route is not one serial chain of multiplications. The lanes are
+ * combined with the splitmix64 mixer, so the top bits (the shard) and the low bits (the
+ * slot) both depend on every vertex.
+ */
+uint64_t FitnessCache::fingerprint(const vector<vector<int>>& routes) {
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t lane[4] = {routes.size(), 0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull};
+    auto mix = [multiplier](uint64_t h, uint64_t word) {
+        h = (h ^ word) * multiplier;
+        return (h << 31) | (h >> 33);
+    };
+    auto pack = [](int a, int b) { return static_cast<uint64_t>(static_cast<uint32_t>(a)) | static_cast<uint64_t>(b) << 32; };
+    for (const vector<int>& route : routes) {
+        const int* v = route.data();
+        size_t size = route.size();
+        lane[0] = mix(lane[0], size);
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            for (int l = 0; l < 4; ++l) {
+                lane[l] = mix(lane[l], pack(v[i + 2 * l], v[i + 2 * l + 1]));
+            }
+        }
+        for (; i < size; ++i) {
+            lane[i & 3] = mix(lane[i & 3], static_cast<uint32_t>(v[i]) | uint64_t(1) << 63);
+        }
+    }
+    uint64_t h = lane[0];
+    for (int l = 1; l < 4; ++l) {
+        h = mix(h, lane[l]);
+    }
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return h != 0 ? h : 1;
+}
+
+/**
+ * @brief Looks up the fitness of a fingerprint and counts the hit or miss.
+ *
+ * @return Whether the fingerprint was found; fitness is set only then.
+ */
+bool FitnessCache::find(uint64_t key, float& fitness) {
+    Shard& shard = shardOf(key);
+    size_t slot = slotOf(key);
+    {
+        lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = slot; i < slot + 2; ++i) {
+            if (shard.slots[i].key == key) {
+                fitness = shard.slots[i].fitness;
+                hitCount.fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    missCount.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+/**
+ * @brief Stores the fitness of a fingerprint in the first slot of its set; the entry there
+ *        moves to the second slot, replacing what was there.
+ */
+void FitnessCache::insert(uint64_t key, float fitness) {
+    Shard& shard = shardOf(key);
+    size_t slot = slotOf(key);
+    lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.slots[slot].key != key) {
+        shard.slots[slot + 1] = shard.slots[slot];
+    }
+    shard.slots[slot] = {key, fitness};
+}
@@ -0,0 +1,60 @@
+#ifndef FITNESS_CACHE_H
+#define FITNESS_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @file fitnessCache.h
+ * @brief Bounded cache of GA fitness values keyed by a 64-bit fingerprint of the routes.
+ *
+ * The table is split into shardCount shards, each behind its own mutex, so concurrent
+ * evaluations rarely wait on each other. Every shard is two-way set associative: a key
+ * may live in one of two neighbouring slots, the most recently stored first, and a new
+ * key evicts the older one. Fitness is a pure function of the routes, so an evicted or
+ * missing entry only costs a recomputation. Two different chromosomes with the same
+ * fingerprint would share a fitness; at 64 bits that is not expected to happen.
+ */
+class FitnessCache {
+public:
+    static constexpr int shardCount = 16;
+    static constexpr std::size_t defaultCapacity = std::size_t(1) << 16;
+
+    /**
+     * @param capacity The number of entries, rounded up to a power of two of at least
+     *        two per shard.
+     */
+    explicit FitnessCache(std::size_t capacity = defaultCapacity);
+
+    static uint64_t fingerprint(const std::vector<std::vector<int>>& routes);
+
+    bool find(uint64_t key, float& fitness);
+    void insert(uint64_t key, float fitness);
+
+    uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return missCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint64_t key = 0;  ///< 0 marks an empty slot; fingerprint never returns 0.
+        float fitness = 0;
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry> slots;
+    };
+
+    Shard& shardOf(uint64_t key) { return shards[key >> 60]; }
+    std::size_t slotOf(uint64_t key) const { return static_cast<std::size_t>(key) & slotMask & ~std::size_t(1); }
+
+    std::array<Shard, shardCount> shards;
+    std::size_t slotMask = 0;
+    std::atomic<uint64_t> hitCount{0};
+    std::atomic<uint64_t> missCount{0};
+};
+
+#endif // FITNESS_CACHE_H
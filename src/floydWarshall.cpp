@@ -0,0 +1,188 @@
+#include "floydWarshall.h"
+#include "threadPool.h"
+#include "denseDijkstra.h"
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+/// Unreachable; small enough that the sum of two never overflows.
+const int32_t infinity = numeric_limits<int32_t>::max() / 2;
+
+/**
+ * @brief c[j] = min(c[j], aik + b[j]) for j < T, setting cNext[j] to nextIk where lowered.
+ */
+void minPlusRow(int32_t* c, int32_t* cNext, const int32_t* b, int32_t aik, int32_t nextIk) {
+    const int T = DistanceTable::tileSize;
+    int j = 0;
+#if defined(__AVX2__)
+    const __m256i through = _mm256_set1_epi32(aik);
+    const __m256i hop = _mm256_set1_epi32(nextIk);
+    for (; j + 8 <= T; j += 8) {
+        __m256i candidate = _mm256_add_epi32(through, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j)));
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + j));
+        __m256i shorter = _mm256_cmpgt_epi32(current, candidate);
+        if (_mm256_testz_si256(shorter, shorter)) {
+            continue;
+        }
+        __m256i oldNext = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cNext + j));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + j), _mm256_min_epi32(current, candidate));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(cNext + j), _mm256_blendv_epi8(oldNext, hop, shorter));
+    }
+#elif defined(__SSE4_1__)
+    const __m128i through = _mm_set1_epi32(aik);
+    const __m128i hop = _mm_set1_epi32(nextIk);
+    for (; j + 4 <= T; j += 4) {
+        __m128i candidate = _mm_add_epi32(through, _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j)));
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + j));
+        __m128i shorter = _mm_cmpgt_epi32(current, candidate);
+        if (_mm_testz_si128(shorter, shorter)) {
+            continue;
+        }
+        __m128i oldNext = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cNext + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(c + j), _mm_min_epi32(current, candidate));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cNext + j), _mm_blendv_epi8(oldNext, hop, shorter));
+    }
+#endif
+    for (; j < T; ++j) {
+        if (aik + b[j] < c[j]) {
+            c[j] = aik + b[j];
+            cNext[j] = nextIk;
+        }
+    }
+}
+
+/**
+ * @brief Relaxes tile (ci, cj) through the vertices of tile k, i.e. via tiles (ci, k) and (k, cj).
+ *
+ * The pivot loop is outermost, so the call is also correct when (ci, k) or (k, cj) is the
+ * tile being updated (phases 1 and 2).
+ */
+void relaxTile(int32_t* dist, int32_t* next, int stride, int ci, int cj, int k) {
+    const int T = DistanceTable::tileSize;
+    for (int kk = 0; kk < T; ++kk) {
+        int pivot = k * T + kk;
+        const int32_t* b = dist + static_cast<size_t>(pivot) * stride + cj * T;
+        for (int i = 0; i < T; ++i) {
+            size_t row = static_cast<size_t>(ci * T + i) * stride;
+            int32_t aik = dist[row + pivot];
+            if (aik >= infinity) {
+                continue;
+            }
+            minPlusRow(dist + row + cj * T, next + row + cj * T, b, aik, next[row + pivot]);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Computes the distances and next hops between all pairs of vertices.
+ *
+ * Every tile is updated by exactly one task per phase and reads only tiles finished in an
+ * earlier phase, so the table is the same for any number of threads.
+ *
+ * @param adjMatrix The adjacency matrix; adjMatrix[u][v] > 0 is the weight of edge (u, v).
+ * @param vertices The number of vertices (at most maxVertices).
+ * @param threads The number of worker threads.
+ * @return The table.
+ */
+DistanceTable DistanceTable::build(const vector<vector<int>>& adjMatrix, int vertices, unsigned threads) {
+    DistanceTable table;
+    table.vertices = vertices;
+    int tiles = (vertices + tileSize - 1) / tileSize;
+    int stride = tiles * tileSize;
+    table.stride = stride;
+    table.dist.assign(static_cast<size_t>(stride) * stride, infinity);
+    table.next.assign(static_cast<size_t>(stride) * stride, -1);
+    for (int u = 0; u < vertices; ++u) {
+        size_t row = static_cast<size_t>(u) * stride;
+        for (int v = 0; v < vertices; ++v) {
+            if (adjMatrix[u][v] > 0) {
+                table.dist[row + v] = adjMatrix[u][v];
+                table.next[row + v] = v;
+            }
+        }
+        table.dist[row + u] = 0;
+        table.next[row + u] = u;
+    }
+
+    int32_t* dist = table.dist.data();
+    int32_t* next = table.next.data();
+    ThreadPool pool(threads);
+    size_t others = static_cast<size_t>(tiles - 1);
+    for (int k = 0; k < tiles; ++k) {
+        relaxTile(dist, next, stride, k, k, k);
+        parallelFor(pool, 2 * others, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                int other = static_cast<int>(t % others);
+                other += other >= k ? 1 : 0;
+                if (t < others) {
+                    relaxTile(dist, next, stride, k, other, k);
+                } else {
+                    relaxTile(dist, next, stride, other, k, k);
+                }
+            }
+        });
+        parallelFor(pool, others * others, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                int ci = static_cast<int>(t / others);
+                int cj = static_cast<int>(t % others);
+                ci += ci >= k ? 1 : 0;
+                cj += cj >= k ? 1 : 0;
+                relaxTile(dist, next, stride, ci, cj, k);
+            }
+        });
+    }
+    return table;
+}
+
+/**
+ * @brief Tells whether a table pays off against one Dijkstra search per query.
+ *
+ * Measured on one core, the table costs about 0.25 ns * V^3 and a dense Dijkstra query
+ * about 0.45 ns * V^2 (it stops early at its target), so the table wins from roughly
+ * V / 2 queries per thread. Path expansion asks about V / 4 queries, so the table is
+ * used only with several threads.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The number of edges.
+ * @param queries The number of paths that will be asked for.
+ * @param threads The number of threads available for the build.
+ */
+bool DistanceTable::worthBuilding(int vertices, long long edges, size_t queries, unsigned threads) {
+    if (vertices < tileSize || vertices > maxVertices || !preferDenseDijkstra(vertices, edges)) {
+        return false;
+    }
+    return static_cast<double>(queries) * threads >= vertices;
+}
+
+/**
+ * @brief Returns the length of a shortest u-v path, or -1 if v cannot be reached.
+ */
+int DistanceTable::distance(int u, int v) const {
+    int32_t d = dist[static_cast<size_t>(u) * stride + v];
+    return d >= infinity ? -1 : d;
+}
+
+/**
+ * @brief Appends the steps of a shortest s-t path to out.
+ *
+ * @return false (and appends nothing) if t cannot be reached from s.
+ */
+bool DistanceTable::appendPath(int s, int t, vector<pair<int, int>>& out) const {
+    if (next[static_cast<size_t>(s) * stride + t] == -1) {
+        return false;
+    }
+    for (int u = s; u != t;) {
+        int v = next[static_cast<size_t>(u) * stride + t];
+        out.emplace_back(u, v);
+        u = v;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef FLOYD_WARSHALL_H
+#define FLOYD_WARSHALL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @file floydWarshall.h
+ * @brief All-pairs shortest distances and next hops from a blocked Floyd-Warshall.
+ *
+ * The matrix is cut into square tiles small enough that the three tiles of one update stay
+ * in L1/L2. Round k first closes the diagonal tile (k, k), then the other tiles of row and
+ * column k, then all remaining tiles; the tiles of the last two phases are independent and
+ * run on a thread pool. The min-plus inner loop uses AVX2 or SSE4.1 when available.
+ * Distances are 32-bit; next hops are stored beside them so paths can be read off directly.
+ */
+class DistanceTable {
+public:
+    static constexpr int tileSize = 64;
+    static constexpr int maxVertices = 4096;  ///< 128 MiB for distances and next hops.
+
+    static DistanceTable build(const std::vector<std::vector<int>>& adjMatrix, int vertices, unsigned threads);
+    static bool worthBuilding(int vertices, long long edges, std::size_t queries, unsigned threads);
+
+    int getVertices() const { return vertices; }
+    int distance(int u, int v) const;
+    bool appendPath(int s, int t, std::vector<std::pair<int, int>>& out) const;
+
+private:
+    int vertices = 0;
+    int stride = 0;  ///< Row length, vertices rounded up to a whole tile.
+    std::vector<int32_t> dist;
+    std::vector<int32_t> next;  ///< First vertex after u on a shortest u-v path, -1 if none.
+};
+
+#endif // FLOYD_WARSHALL_H
@@ -0,0 +1,205 @@
+#include "gaCheckpoint.h"
+#include "binaryFormat.h"
+#include "resultWriter.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+static const uint8_t checkpointMagic[4] = {'C', 'P', 'G', 'C'};
+static const uint8_t checkpointVersion = 2;
+
+namespace {
+
+void appendVarint(vector<uint8_t>& out, uint64_t value) {
+    uint8_t bytes[10];
+    size_t n = encodeVarint(value, bytes);
+    out.insert(out.end(), bytes, bytes + n);
+}
+
+void appendU32(vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+/**
+ * @brief Appends the state of an engine as the words of its textual representation.
+ */
+void appendEngine(vector<uint8_t>& out, const mt19937& engine) {
+    ostringstream text;
+    text << engine;
+    istringstream words(text.str());
+    vector<uint32_t> state;
+    for (uint32_t word; words >> word;) {
+        state.push_back(word);
+    }
+    appendVarint(out, state.size());
+    for (uint32_t word : state) {
+        appendU32(out, word);
+    }
+}
+
+void readEngine(ByteReader& in, mt19937& engine) {
+    uint64_t count = in.varint();
+    ostringstream text;
+    for (uint64_t i = 0; i < count; ++i) {
+        text << in.u32() << ' ';
+    }
+    istringstream state(text.str());
+    state >> engine;
+    if (state.fail()) {
+        throw runtime_error("Invalid random engine state in checkpoint.");
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Encodes the state of the genetic search as a checkpoint.
+ *
+ * @param state The state after the last finished generation.
+ * @param vertices The number of vertices of the graph.
+ * @param edges The number of edges of the graph.
+ * @param edgeCrc The fingerprint of the graph's edge list (Graph::edgeFingerprint).
+ * @param out Receives the checkpoint; its capacity is reused.
+ */
+void encodeGeneticCheckpoint(const GeneticState& state, int vertices, long long edges, uint32_t edgeCrc,
+                             vector<uint8_t>& out) {
+    out.assign(checkpointMagic, checkpointMagic + 4);
+    out.push_back(checkpointVersion);
+    appendVarint(out, static_cast<uint64_t>(vertices));
+    appendVarint(out, static_cast<uint64_t>(edges));
+    appendU32(out, edgeCrc);
+    appendVarint(out, static_cast<uint64_t>(state.postmen));
+    appendVarint(out, zigzagEncode(state.seed));
+    appendVarint(out, static_cast<uint64_t>(state.generations));
+    appendVarint(out, static_cast<uint64_t>(state.nextGeneration));
+    uint32_t fitnessBits;
+    memcpy(&fitnessBits, &state.fitness, sizeof(fitnessBits));
+    appendU32(out, fitnessBits);
+    appendVarint(out, zigzagEncode(state.longest));
+    appendEngine(out, state.populationRng);
+    appendEngine(out, state.mutationRng);
+    for (const vector<int>& route : state.population) {
+        appendVarint(out, route.size());
+        for (int vertex : route) {
+            appendVarint(out, static_cast<uint64_t>(vertex));
+        }
+    }
+    appendU32(out, crc32Update(0, out.data(), out.size()));
+}
+
+/**
+ * @brief Reads a checkpoint of the genetic search.
+ *
+ * @param path The checkpoint file.
+ * @param vertices The number of vertices of the graph being solved.
+ * @param edges The number of edges of the graph being solved.
+ * @param edgeCrc The fingerprint of the edge list of the graph being solved.
+ * @param postmen The number of postmen of the run.
+ * @param seed The seed of the run.
+ * @param generations The number of generations of the run.
+ * @return The state to continue from.
+ *
+ * @throws std::runtime_error If the file cannot be read, is damaged, holds a vertex the
+ *         graph does not have or was written for another graph or another run.
+ */
+GeneticState readGeneticCheckpoint(const string& path, int vertices, long long edges, uint32_t edgeCrc, int postmen,
+                                   int seed, int generations) {
+    vector<uint8_t> bytes = readWholeFile(path);
+    if (bytes.size() < 4 + 1 + 4 || !equal(bytes.begin(), bytes.begin() + 4, checkpointMagic)) {
+        throw runtime_error("Not a checkpoint file: " + path);
+    }
+    if (crc32Update(0, bytes.data(), bytes.size() - 4) != ByteReader(bytes.data() + bytes.size() - 4, 4).u32()) {
+        throw runtime_error("Checksum mismatch in checkpoint file: " + path);
+    }
+    ByteReader in(bytes.data(), bytes.size() - 4);
+    for (int i = 0; i < 4; ++i) {
+        in.byte();
+    }
+    if (in.byte() != checkpointVersion) {
+        throw runtime_error("Unsupported checkpoint version: " + path);
+    }
+    if (in.varint() != static_cast<uint64_t>(vertices) || in.varint() != static_cast<uint64_t>(edges) ||
+        in.u32() != edgeCrc) {
+        throw runtime_error("Checkpoint " + path + " was written for another graph.");
+    }
+    GeneticState state;
+    state.postmen = static_cast<int>(in.varint());
+    state.seed = static_cast<int>(in.zigzag());
+    state.generations = static_cast<int>(in.varint());
+    if (state.postmen != postmen || state.seed != seed || state.generations != generations) {
+        throw runtime_error("Checkpoint " + path + " was written for another number of postmen, seed or generations.");
+    }
+    state.nextGeneration = static_cast<int>(in.varint());
+    uint32_t fitnessBits = in.u32();
+    memcpy(&state.fitness, &fitnessBits, sizeof(fitnessBits));
+    state.longest = in.zigzag();
+    readEngine(in, state.populationRng);
+    readEngine(in, state.mutationRng);
+    state.population.resize(state.postmen);
+    for (vector<int>& route : state.population) {
+        route.resize(in.varint());
+        for (int& vertex : route) {
+            uint64_t value = in.varint();
+            if (value >= static_cast<uint64_t>(vertices)) {
+                throw runtime_error("Invalid vertex in checkpoint file: " + path);
+            }
+            vertex = static_cast<int>(value);
+        }
+    }
+    return state;
+}
+
+CheckpointWriter::CheckpointWriter(const string& path) : path(path), writer([this]() { writerLoop(); }) {}
+
+/**
+ * @brief Writes the checkpoint still waiting, if any, and stops the writer thread.
+ */
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    writer.join();
+}
+
+/**
+ * @brief Hands a checkpoint to the writer thread.
+ *
+ * @param bytes The encoded checkpoint; receives a spare buffer in exchange.
+ */
+void CheckpointWriter::submit(vector<uint8_t>& bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(bytes);
+        hasPending = true;
+    }
+    ready.notify_one();
+}
+
+void CheckpointWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        ready.wait(lock, [this]() { return hasPending || stopping; });
+        if (!hasPending) {
+            return;
+        }
+        writing.swap(pending);
+        hasPending = false;
+        lock.unlock();
+
+        string temporary = path + ".tmp";
+        BufferedFile file(temporary);
+        file.write(reinterpret_cast<const char*>(writing.data()), writing.size());
+        if (!file.close() || rename(temporary.c_str(), path.c_str()) != 0) {
+            cerr << "Unable to write checkpoint " << path << endl;
+        }
+        lock.lock();
+    }
+}
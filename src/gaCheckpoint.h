@@ -0,0 +1,80 @@
+#ifndef GA_CHECKPOINT_H
+#define GA_CHECKPOINT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file gaCheckpoint.h
+ * @brief Checkpoints of the genetic search (--checkpoint, --resume).
+ *
+ * Checkpoint file, version 2:
+ * @code
+ * "CPGC" u8:version varint:vertices varint:edges u32le:edgeCrc varint:postmen zigzag:seed
+ * varint:generations varint:nextGeneration u32le:fitness (float bits) zigzag:longest
+ * rng rng                              (population, then mutation engine)
+ *   rng:        varint:words u32le*    (the engine's textual state, word by word)
+ * route*                               (one per postman)
+ *   route:      varint:length varint:vertex*
+ * u32le:crc32
+ * @endcode
+ * The graph size and edge list (edgeCrc, Graph::edgeFingerprint), postmen, seed and
+ * generations identify the run a checkpoint belongs to. The final CRC-32 covers every byte
+ * before it.
+ */
+
+/// Everything the genetic search carries from one generation to the next.
+struct GeneticState {
+    int postmen = 0;
+    int seed = 0;
+    int generations = 0;       ///< Generations of the whole run.
+    int nextGeneration = 1;    ///< Loop index of the next generation to run.
+    float fitness = 0;         ///< Fitness of population, the best so far.
+    long long longest = -1;    ///< Longest route of population, -1 if it is not a valid solution.
+    std::mt19937 populationRng;
+    std::mt19937 mutationRng;
+    std::vector<std::vector<int>> population;
+};
+
+void encodeGeneticCheckpoint(const GeneticState& state, int vertices, long long edges, uint32_t edgeCrc,
+                             std::vector<uint8_t>& out);
+GeneticState readGeneticCheckpoint(const std::string& path, int vertices, long long edges, uint32_t edgeCrc, int postmen,
+                                   int seed, int generations);
+
+/**
+ * @brief Writes checkpoints on a background thread, so the search never waits for the disk.
+ *
+ * The caller encodes a checkpoint into its buffer and swaps it in with submit. The writer
+ * thread writes one buffer while the next one is filled; a checkpoint submitted while the
+ * previous one is still waiting replaces it. Each file is written next to the target and
+ * renamed over it, so the target always holds a complete checkpoint.
+ */
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void submit(std::vector<uint8_t>& bytes);
+
+private:
+    void writerLoop();
+
+    std::string path;
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> writing;
+    bool hasPending = false;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::thread writer;
+};
+
+#endif // GA_CHECKPOINT_H
@@ -4,17 +4,22 @@
 #include <random>
 #include <algorithm>
 #include <fstream>
-#include <nlohmann/json.hpp>
+#include <memory>
+#include <stdexcept>
+#include "resultWriter.h"
+#include "gaCheckpoint.h"
+#include "fitnessCache.h"
+#include "lowerBound.h"
+#include "memoryStats.h"
+#include "trace.h"
 
 using namespace std;
 
-using json = nlohmann::json;
-
 /**
  * @file genetic.cpp
  * @brief Generates a shuffled list of vertices that have edges.
  *
- * This function iterates through the adjacency matrix to find vertices that have at least one edge.
+ * This function reads the degree of every vertex from the graph summary and keeps those with at least one edge.
  * It then shuffles these vertices using a random number generator.
  *
  * @param vertices The total number of vertices in the graph.
@@ -23,11 +28,8 @@ using json = nlohmann::json;
 vector<int> Graph::shuffeledVertices(int vertices){
     vector<int> verticesWithEdges;
     for (int i = 0; i < vertices; ++i) {
-    for (int j = 0; j < vertices; ++j) {
-            if (adjMatrix[i][j] > 0) {
-                verticesWithEdges.push_back(i);
-                break;
-            }
+        if (summary.degree(i) > 0) {
+            verticesWithEdges.push_back(i);
         }
     }
     mt19937 gen(getSeed());
@@ -39,10 +41,9 @@ vector<int> Graph::shuffeledVertices(int vertices){
 /// @param verticesWithEdges 
 /// @param n 
 /// @param totalEdges 
+/// @param gen The population engine of the search.
 /// @return 
-vector<vector<int>> createPopulation(vector<int> verticesWithEdges, int n, int totalEdges){
-    random_device rd;
-    mt19937 gen(rd());
+vector<vector<int>> createPopulation(const vector<int>& verticesWithEdges, int n, int totalEdges, mt19937& gen){
     vector<vector<int>> postmenRoutes(n);
     
     uniform_int_distribution<> dist(1, totalEdges);
@@ -69,8 +70,7 @@ vector<vector<int>> createPopulation(vector<int> verticesWithEdges, int n, int t
  *              of nodes in a route.
  * @return The fitness value of the given routes. Higher values indicate better fitness.
  */
-float Graph::testFitness(vector<vector<int>> route) {
-    vector<vector<int>> adjMatrix = getAdjMatrix();
+float Graph::testFitness(const vector<vector<int>>& route) {
     int totalEdges = getEdges();
 
     float fitness = 0;
@@ -163,14 +163,13 @@ vector<vector<int>> crossover(const vector<vector<int>>& population1, const vect
  * @param population A reference to a vector of vectors representing the population of routes.
  * @param verticesWithEdges A reference to a vector of integers representing vertices that have edges.
  * @param totalEdges An integer representing the total number of edges.
+ * @param gen The mutation engine of the search.
  * 
  * @note The function does nothing if the population or verticesWithEdges are empty.
  */
-void mutate(vector<vector<int>>& population, const vector<int>& verticesWithEdges, int totalEdges) {
+void mutate(vector<vector<int>>& population, const vector<int>& verticesWithEdges, int totalEdges, mt19937& gen) {
     if (population.empty() || verticesWithEdges.empty()) return;
 
-    random_device rd;
-    mt19937 gen(rd());
     uniform_int_distribution<> postmanDist(0, population.size() - 1);
     uniform_int_distribution<> routeDist(0, totalEdges - 1);
     uniform_int_distribution<> vertexDist(0, verticesWithEdges.size() - 1);
@@ -227,6 +226,28 @@ int countValidEdges(const vector<vector<int>>& population, const vector<vector<i
     return validEdges;
 }
 
+/**
+ * @brief Returns the cost of the longest route if the routes form a valid solution, otherwise -1.
+ *
+ * A solution is valid when every step follows an edge of the graph and every edge is used.
+ */
+static long long longestValidRoute(const vector<vector<int>>& population, const vector<vector<int>>& adjMatrix,
+                                   long long edgeCount) {
+    long long longest = 0;
+    for (const auto& route : population) {
+        long long cost = 0;
+        for (size_t i = 0; i + 1 < route.size(); ++i) {
+            int weight = adjMatrix[route[i]][route[i + 1]];
+            if (weight <= 0) {
+                return -1;
+            }
+            cost += weight;
+        }
+        longest = max(longest, cost);
+    }
+    return countValidEdges(population, adjMatrix) == edgeCount ? longest : -1;
+}
+
 /**
  * @brief Solves the Chinese Postman Problem using a genetic algorithm.
  * 
@@ -241,16 +262,24 @@ int countValidEdges(const vector<vector<int>>& population, const vector<vector<i
  * 2. Creates an initial population of possible solutions.
  * 3. Evaluates the fitness of the initial population.
  * 4. Iteratively generates new populations through crossover and mutation, 
- *    selecting the best population based on fitness.
+ *    selecting the best population based on fitness. Whenever the best population is a
+ *    valid solution whose longest route is within the --gap target of the lower bound
+ *    (see minMaxLowerBound), the search stops early.
  * 5. Prints the fitness and routes of the first and last generations.
- * 6. Calculates and prints the accuracy and correctness of the final solution.
- * 7. Saves the results to a JSON file.
+ * 6. Prints the gap to the lower bound and the correctness of the final solution.
+ * 7. Streams the results to a JSON file.
  * 
- * The fitness of a population is evaluated using the `testFitness` function.
+ * The fitness of a population is evaluated using the `testFitness` function, behind a
+ * FitnessCache, as the same populations come up again and again.
  * The population is evolved using the `createPopulation`, `crossover`, and `mutate` functions.
- * The final results are saved to a file named "resultsGenetic.json".
+ * Their random numbers come from two engines seeded with the seed, so a run is a function
+ * of the seed, and the whole search state is a GeneticState. With --checkpoint it is
+ * written every checkpointEvery generations by a CheckpointWriter; a resume state, read
+ * from such a checkpoint (--resume), continues with the same result as the uninterrupted run.
+ * The final results are saved to a file named "resultsGenetic.json" (or "resultsGenetic.cpr").
  */
-void Graph::solveGenetic(int n, int x) { // number of postmen, number of generations
+void Graph::solveGenetic(int n, int x, GeneticState* resume) { // number of postmen, number of generations, checkpoint to continue from
+    PhaseScope phase(Phase::Genetic);
     vector<int> verticesWithEdges = shuffeledVertices(getVertices());
     if (n > verticesWithEdges.size()) {
         cerr << "Number of postmen cannot be greater than the number of vertices." << endl;
@@ -263,84 +292,148 @@ void Graph::solveGenetic(int n, int x) { // number of postmen, number of generat
     }
 
     // basis for genetic algorithm
-    vector<vector<int>> population = createPopulation(verticesWithEdges, n, getEdges());
-    float fitness = testFitness(population);
+    long long edgeCount = summary.edgeCount();
+    FitnessCache fitnessCache(min(FitnessCache::defaultCapacity, 2 * static_cast<size_t>(max(x, 1))));
+    auto cachedFitness = [&](const vector<vector<int>>& candidate) {
+        uint64_t key = FitnessCache::fingerprint(candidate);
+        float value;
+        if (!fitnessCache.find(key, value)) {
+            value = testFitness(candidate);
+            fitnessCache.insert(key, value);
+        }
+        return value;
+    };
+    GeneticState state;
+    if (resume) {
+        state = move(*resume);
+    } else {
+        state.postmen = n;
+        state.seed = getSeed();
+        state.generations = x;
+        seed_seq populationSeed{getSeed(), 1};
+        seed_seq mutationSeed{getSeed(), 2};
+        state.populationRng.seed(populationSeed);
+        state.mutationRng.seed(mutationSeed);
+        state.population = createPopulation(verticesWithEdges, n, getEdges(), state.populationRng);
+        state.fitness = cachedFitness(state.population);
+        state.longest = longestValidRoute(state.population, adjMatrix, edgeCount);
+    }
+    vector<vector<int>>& population = state.population;
+    float& fitness = state.fitness;
+    long long& longest = state.longest;
+    RouteLowerBound bound = minMaxLowerBound(vertices, getWeightedEdges(), n);
+    auto gapReached = [&]() { return longest >= 0 && optimalityGap(longest, bound.maxRoute) <= options.gapTarget; };
+    unique_ptr<CheckpointWriter> checkpoints;
+    vector<uint8_t> checkpoint;
+    uint32_t edgeCrc = 0;
+    if (!options.checkpointFile.empty()) {
+        checkpoints = make_unique<CheckpointWriter>(options.checkpointFile);
+        edgeCrc = edgeFingerprint();
+    }
 
     // Print first generation
-    cout << "Generation 1 fitness: " << fitness << endl;
-    for (int i = 0; i < n; ++i) {
-        cout << "Postman " << i + 1 << " route: ";
-        for (int vertex : population[i]) {
-            cout << vertex << " ";
+    if (resume) {
+        cout << "Resumed from " << options.resumeFile << " at generation " << state.nextGeneration + 1 << " fitness: " << fitness << endl;
+    } else {
+        cout << "Generation 1 fitness: " << fitness << endl;
+    }
+    if (!options.quiet && !resume) {
+        for (int i = 0; i < n; ++i) {
+            cout << "Postman " << i + 1 << " route: ";
+            for (int vertex : population[i]) {
+                cout << originalVertex(vertex) << " ";
+            }
+            cout << '\n';
         }
-        cout << endl;
     }
 
-    for (int gen = 1; gen < x; ++gen) {
-        vector<vector<int>> newPopulation = createPopulation(verticesWithEdges, n, getEdges());
-        float newFitness = testFitness(newPopulation);
+    int lastGen = x;
+    for (int gen = state.nextGeneration; gen < x && !gapReached(); ++gen) {
+        TraceScope trace("generation", gen + 1);
+        vector<vector<int>> newPopulation = createPopulation(verticesWithEdges, n, getEdges(), state.populationRng);
+        float newFitness = cachedFitness(newPopulation);
+        bool improved = false;
 
         if (newFitness > fitness) {
             population = newPopulation;
             fitness = newFitness;
+            improved = true;
         }
 
         if (gen < x - 1) {
             vector<vector<int>> population1 = population;
-            vector<vector<int>> population2 = createPopulation(verticesWithEdges, n, getEdges());
+            vector<vector<int>> population2 = createPopulation(verticesWithEdges, n, getEdges(), state.populationRng);
 
             vector<vector<int>> crossoverPopulation = crossover(population1, population2,getSeed());
-            mutate(crossoverPopulation, verticesWithEdges, getEdges());
+            mutate(crossoverPopulation, verticesWithEdges, getEdges(), state.mutationRng);
 
-            float crossoverFitness = testFitness(crossoverPopulation);
+            float crossoverFitness = cachedFitness(crossoverPopulation);
             if (crossoverFitness > fitness) {
                 population = crossoverPopulation;
                 fitness = crossoverFitness;
+                improved = true;
+            }
+        }
+
+        if (improved) {
+            longest = longestValidRoute(population, adjMatrix, edgeCount);
+            if (gapReached()) {
+                lastGen = gen + 1;
+                cout << "Gap target reached, stopping after generation " << lastGen << endl;
             }
         }
+
+        state.nextGeneration = gen + 1;
+        if (checkpoints && state.nextGeneration % options.checkpointEvery == 0 && state.nextGeneration < x && !gapReached()) {
+            encodeGeneticCheckpoint(state, vertices, edgeCount, edgeCrc, checkpoint);
+            checkpoints->submit(checkpoint);
+        }
     }
+    checkpoints.reset();
 
     // Print last generation
-    cout << "Generation " << x << " fitness: " << fitness << endl;
+    cout << "Generation " << lastGen << " fitness: " << fitness << endl;
     int totalEdgesLastGen = 0;
     for (int i = 0; i < n; ++i) {
-        cout << "Postman " << i + 1 << " route: ";
-        for (int vertex : population[i]) {
-            cout << vertex << " ";
+        if (!options.quiet) {
+            cout << "Postman " << i + 1 << " route: ";
+            for (int vertex : population[i]) {
+                cout << originalVertex(vertex) << " ";
+            }
+            cout << '\n';
         }
         totalEdgesLastGen += population[i].size() - 1; // Count edges in the route
-        cout << endl;
     }
 
-    float accuracy = 1; 
-    accuracy = (float)getEdges() / (float)totalEdgesLastGen; 
-    cout << "Accuracy: " << accuracy * 100 <<"%"<< endl;
+    if (longest >= 0) {
+        cout << "Longest route: " << longest << ", lower bound: " << bound.maxRoute << endl;
+        cout << "Gap: " << optimalityGap(longest, bound.maxRoute) * 100 << "%" << endl;
+    } else {
+        cout << "Gap: unknown, the solution is not valid (lower bound: " << bound.maxRoute << ")" << endl;
+    }
     cout << "Total edges in last generation: " << totalEdgesLastGen << endl;
     // cout << "get Edges: " << getEdges() << endl;
 
     int validEdges = countValidEdges(population, adjMatrix);
     cout << "Number of valid edges in the solution: " << validEdges << endl;
     cout << "Correctness: " << ( (float)validEdges / (float)getEdges() ) * 100 << "%" << endl;
+    uint64_t lookups = fitnessCache.hits() + fitnessCache.misses();
+    cout << "Fitness cache: " << fitnessCache.hits() << " hits of " << lookups << " evaluations ("
+         << (lookups > 0 ? 100.0 * fitnessCache.hits() / lookups : 0.0) << "%)" << endl;
 
-    // Save results to JSON
-    json result;
+    // Stream results to JSON
+    string outputPath = resultPath("resultsGenetic", options.format);
+    unique_ptr<RouteWriter> writer = openRouteWriter(outputPath, options.format);
     for (int i = 0; i < n; ++i) {
-        json postmanData;
-        for (int j = 0; j < population[i].size() - 1; ++j) {
-            postmanData.push_back({population[i][j], population[i][j + 1]});
+        writer->beginPostman();
+        for (size_t j = 0; j + 1 < population[i].size(); ++j) {
+            writer->addEdge(originalVertex(population[i][j]), originalVertex(population[i][j + 1]));
         }
-        result["postmen"][i] = {
-            {"routes", postmanData},
-            {"cost", testFitness(population)}
-        };
+        writer->endPostman(static_cast<double>(fitness));
     }
 
-
-    ofstream file("resultsGenetic.json");
-    if (file.is_open()) {
-        file << result.dump();
-        file.close();
-        cout << "Results saved to resultsGenetic.json" << endl;
+    if (writer->isOpen() && writer->finish()) {
+        cout << "Results saved to " << outputPath << endl;
     } else {
         cerr << "Unable to open file for writing." << endl;
     }
@@ -376,7 +469,7 @@ pair<int, int> Graph::findBestPopulations(std::vector<float> &fitnessScores, std
     vector<vector<int>> secondBestPopulation = populations[secondBestPopulationIndex];
     *maxFitnessIt = bestFitness; // Restore the best fitness score
 
-    cout << "Best population fitness: " << bestFitness << endl;   commented for test
+    cout << "Best population fitness: " << bestFitness << endl;   // commented for test
     cout << "Best population: " << bestPopulationIndex + 1 << endl;
 
     for (int i = 0; i < n; ++i)
@@ -384,12 +477,12 @@ pair<int, int> Graph::findBestPopulations(std::vector<float> &fitnessScores, std
         cout << "Postman " << i + 1 << " best route: ";
         for (int vertex : bestPopulation[i])
         {
-            cout << vertex << " ";
+            cout << originalVertex(vertex) << " ";
         }
         cout << endl;
     }
 
-    cout << "Second best population fitness: " << *secondMaxFitnessIt << endl;  test
+    cout << "Second best population fitness: " << *secondMaxFitnessIt << endl;  // test
     cout << "Second best population: " << secondBestPopulationIndex + 1 << endl; // test
 
     for (int i = 0; i < n; ++i)  
@@ -397,7 +490,7 @@ pair<int, int> Graph::findBestPopulations(std::vector<float> &fitnessScores, std
         cout << "Postman " << i + 1 << " second best route: ";
         for (int vertex : secondBestPopulation[i])
         {
-            cout << vertex << " ";
+            cout << originalVertex(vertex) << " ";
         }
         cout << endl;
     }
@@ -1,4 +1,9 @@
 #include "graph.h"
+#include "binaryFormat.h"
+#include "dotExport.h"
+#include "memoryStats.h"
+#include "trace.h"
+#include "vertexOrder.h"
 #include <limits>
 #include <random>
 #include <iostream>
@@ -14,9 +19,29 @@ using namespace std;
 using json = nlohmann::json;
 
 
+/**
+ * @brief Adds the undirected edge (u, v) with weight 1.
+ *
+ * The adjacency index and the graph summary are updated only when the edge is new,
+ * matching the 0/1 adjacency matrix.
+ */
 void Graph::addEdge(int u, int v) {
     adjMatrix[u][v] = 1;
     adjMatrix[v][u] = 1;
+    if (adjacency.add(u, v)) {
+        summary.onEdgeAdded(u, v, 1);
+    }
+}
+
+/**
+ * @brief Removes the undirected edge (u, v) if it is present.
+ */
+void Graph::removeEdge(int u, int v) {
+    if (adjacency.remove(u, v)) {
+        summary.onEdgeRemoved(u, v, adjMatrix[u][v]);
+    }
+    adjMatrix[u][v] = 0;
+    adjMatrix[v][u] = 0;
 }
 
 
@@ -25,17 +50,32 @@ void Graph::addEdge(int u, int v) {
  * @file graph.cpp
  * This constructor reads a JSON file containing the graph's vertices and edges,
  * initializes the adjacency matrix, and adds the edges to the graph.
+ * Files in the binary graph format (see binaryFormat.h) are recognized by their
+ * magic bytes and loaded without JSON parsing.
  * 
- * @param jsonFile The path to the JSON file containing the graph data.
+ * @param jsonFile The path to the JSON or binary file containing the graph data.
  * 
  * @throws std::runtime_error If the JSON file cannot be opened.
  * @throws std::runtime_error If the JSON format is invalid (missing 'vertices' or 'edges' fields).
  * @throws std::runtime_error If an edge contains a vertex that is out of bounds.
  */
 Graph::Graph(const std::string& jsonFile) {
+    PhaseScope phase(Phase::Load);
+    TraceScope trace("load");
+    if (isBinaryGraph(jsonFile)) {
+        vector<pair<int, int>> edges;
+        readBinaryGraph(jsonFile, vertices, edges);
+        adjMatrix.resize(vertices, std::vector<int>(vertices, 0));
+        adjacency.reset(vertices, AdjacencyIndex::chooseLayout(vertices, static_cast<long long>(edges.size())));
+        summary.reset(vertices);
+        for (const auto& [u, v] : edges) {
+            addEdge(u, v);
+        }
+        return;
+    }
     std::ifstream file(jsonFile);
     if (!file) {
-        throw std::runtime_error("Error: Could not open JSON file " + jsonFile);
+        throw std::runtime_error("Could not open JSON file " + jsonFile);
     }
     json j;
     file >> j;
@@ -44,6 +84,8 @@ Graph::Graph(const std::string& jsonFile) {
     }
     vertices = j["vertices"];
     adjMatrix.resize(vertices, std::vector<int>(vertices, 0));
+    adjacency.reset(vertices, AdjacencyIndex::chooseLayout(vertices, j["edges"].size()));
+    summary.reset(vertices);
     for (const auto& edge : j["edges"]) {
         int u = edge[0];
         int v = edge[1];
@@ -54,6 +96,22 @@ Graph::Graph(const std::string& jsonFile) {
     }
 }
 
+/**
+ * @brief Constructs a Graph from a list of undirected edges.
+ *
+ * Used to build the per-component graphs solved in planPostmenRoutes.
+ *
+ * @param v The number of vertices in the graph.
+ * @param edges The edges as pairs of vertex indices smaller than v.
+ */
+Graph::Graph(int v, const vector<pair<int, int>>& edges) : vertices(v), adjMatrix(v, vector<int>(v, 0)), seed(0) {
+    adjacency.reset(v, AdjacencyIndex::chooseLayout(v, static_cast<long long>(edges.size())));
+    summary.reset(v);
+    for (const auto& [u, w] : edges) {
+        addEdge(u, w);
+    }
+}
+
 /**
  * @brief Constructs a new Graph object with a specified number of vertices and edge saturation.
  * 
@@ -67,6 +125,8 @@ Graph::Graph(int v, double saturation) : vertices(v), adjMatrix(v, vector<int>(v
     int totalEdges = v * (v - 1) / 2;
     int targetEdges = static_cast<int>(saturation * totalEdges);
     cout << "total: " << totalEdges << "  target: " << targetEdges << endl; 
+    adjacency.reset(v, AdjacencyIndex::chooseLayout(v, targetEdges));
+    summary.reset(v);
     vector<pair<int, int>> allEdges;
     for (int i = 0; i < v; i++) {
         for (int j = i + 1; j < v; j++) { 
@@ -127,50 +187,27 @@ int Graph::getVertices() const {
  * @brief Checks if the graph is Eulerian.
  * 
  * An Eulerian graph is a graph in which all vertices have an even degree.
- * This function iterates through all vertices and checks their degrees.
- * If any vertex has an odd degree, the graph is not Eulerian.
+ * The graph summary keeps the odd-degree set up to date on every edge change,
+ * so this is a constant-time check.
  * 
  * @return true if the graph is Eulerian, false otherwise.
  */
 bool Graph::isEulerian() const {
-    for (int i = 0; i < vertices; ++i) {
-        int degree = 0;
-        for (int j = 0; j < vertices; ++j) {
-            if (adjMatrix[i][j] > 0) {
-                degree++;
-            }
-        }
-        if (degree % 2 != 0) {
-            return false;
-        }
-    }
-    return true;
+    return summary.oddCount() == 0;
 }
 
 
 /**
  * @brief Get the vertices with odd degrees in the graph.
  * 
- * This function iterates through all vertices in the graph and calculates the degree of each vertex.
- * If a vertex has an odd degree, it is added to the list of odd degree vertices.
+ * The odd set is maintained by the graph summary, so only the odd vertices
+ * themselves are visited (and sorted by index).
  * 
  * @return A vector of pairs, where each pair contains a vertex index and its degree, 
  *         for all vertices with odd degrees.
  */
 vector<pair<int, int>> Graph::getOddDegreeVertices() const {
-    vector<pair<int, int>> oddVertices;
-    for (int i = 0; i < vertices; ++i) {
-        int degree = 0;
-        for (int j = 0; j < vertices; ++j) {
-            if (adjMatrix[i][j] > 0) {
-                degree++;
-            }
-        }
-        if (degree % 2 != 0) {
-            oddVertices.emplace_back(i, degree);
-        }
-    }
-    return oddVertices;
+    return summary.oddDegreeVertices();
 }
 
 int Graph::getEdgeWeight(int u, int v) const {
@@ -181,6 +218,20 @@ const vector<vector<int>>& Graph::getAdjMatrix() const {
     return adjMatrix;
 }
 
+const AdjacencyIndex& Graph::getAdjacency() const {
+    return adjacency;
+}
+
+/**
+ * @brief Returns the graph summary, rebuilding its component data first if an edge was removed.
+ */
+const GraphSummary& Graph::getSummary() const {
+    if (summary.componentsStale()) {
+        summary.rebuildComponents(adjacency);
+    }
+    return summary;
+}
+
 void Graph::printAdjMatrix(){
     for (const auto& row : adjMatrix) {
         for (int weight : row) {
@@ -193,47 +244,25 @@ void Graph::printAdjMatrix(){
 /**
  * @brief Exports the graph to a Graphviz DOT format file.
  *
- * This function generates a Graphviz DOT format representation of the graph
- * and writes it to the specified file. Each edge in the graph is assigned a 
- * random color.
+ * All edges are drawn in one color. Above the DOT edge budget of the graph's options
+ * the export is reduced as described in writeDot.
  *
  * @param filename The name of the file to which the Graphviz DOT format will be written.
  */
 void Graph::toGraphviz(const string& filename) const {
-    ofstream outFile(filename);
-    if (!outFile) {
+    vector<vector<pair<int, int>>> groups(1);
+    groups[0].reserve(summary.edgeCount());
+    for (int u = 0; u < vertices; ++u) {
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u < v) {
+                groups[0].emplace_back(originalVertex(u), originalVertex(v));
+            }
+        });
+    }
+    if (!writeDot(filename, vertices, groups, options.dotMaxEdges, options.dotDetail)) {
         cerr << "Error: Could not open file " << filename << " for writing." << endl;
         return;
     }
-
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    uniform_int_distribution<> colorDist(0, 255);
-    int r = colorDist(gen);
-    int g = colorDist(gen);
-    int b = colorDist(gen);
-    
-    outFile << "graph G {" << endl;
-        
-    for (int i = 0; i < vertices; ++i) {
-        for (int j = i + 1; j < vertices; ++j) {  
-            if (adjMatrix[i][j] > 0) {
-                outFile << "  " << i << " -- " << j
-                        << " [color=\"#" 
-                        << std::hex << std::setw(2) << std::setfill('0') << r
-                        << std::setw(2) << g
-                        << std::setw(2) << b
-                        << "\"];" << std::endl;
-                outFile << std::dec;
-                        
-            }
-        }
-    }
-
-    outFile << "}" << endl;
-
-    outFile.close();
     cout << "Graph exported to " << filename << " in Graphviz DOT format." << endl;
 }
 
@@ -245,14 +274,96 @@ int Graph::getSeed() const {
     return seed;
 }
 
-int Graph::getEdges() const {
-    int edgeCount = 0;
-    for (int i = 0; i < vertices; ++i) {
-        for (int j = i + 1; j < vertices; ++j) {
-            if (adjMatrix[i][j] > 0) {
-                edgeCount++;
+void Graph::setOptions(const SolverOptions& options) {
+    this->options = options;
+}
+
+const SolverOptions& Graph::getOptions() const {
+    return options;
+}
+
+/**
+ * @brief Makes solveComponent expand added edges with contraction hierarchy queries.
+ */
+void Graph::setHierarchy(HierarchyView hierarchy) {
+    this->hierarchy = move(hierarchy);
+}
+
+/**
+ * @brief Renumbers the vertices for locality (see computeVertexOrder).
+ *
+ * The adjacency matrix, index and summary are rebuilt under the new numbers. The solvers
+ * translate vertices back with originalVertex when printing or writing routes.
+ *
+ * @param order The ordering to apply; Original leaves the graph unchanged.
+ */
+void Graph::reorderVertices(VertexOrder order) {
+    if (order == VertexOrder::Original) {
+        return;
+    }
+    PhaseScope phase(Phase::Reorder);
+    TraceScope trace("reorder");
+    vector<pair<int, int>> edges;
+    edges.reserve(summary.edgeCount());
+    for (const auto& e : getWeightedEdges()) {
+        edges.emplace_back(e.u, e.v);
+    }
+    vector<int> newId = computeVertexOrder(vertices, edges, order);
+
+    vector<int> previous = originalIds;
+    originalIds.assign(vertices, 0);
+    for (int v = 0; v < vertices; ++v) {
+        originalIds[newId[v]] = previous.empty() ? v : previous[v];
+    }
+    for (auto& row : adjMatrix) {
+        fill(row.begin(), row.end(), 0);
+    }
+    adjacency.reset(vertices, adjacency.getLayout());
+    summary.reset(vertices);
+    for (const auto& [u, v] : edges) {
+        addEdge(newId[u], newId[v]);
+    }
+}
+
+/**
+ * @brief Returns every edge once as (u, v, weight) with u < v.
+ */
+vector<WeightedEdge> Graph::getWeightedEdges() const {
+    vector<WeightedEdge> edges;
+    edges.reserve(summary.edgeCount());
+    for (int u = 0; u < vertices; ++u) {
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u < v) {
+                edges.push_back({u, v, adjMatrix[u][v]});
             }
-        }
+        });
     }
-    return edgeCount - 1;
+    return edges;
+}
+
+/**
+ * @brief CRC-32 of the edge list, every edge once as u32le:u u32le:v u32le:weight with u < v
+ *        in increasing order, so it tells graphs of the same size apart.
+ */
+uint32_t Graph::edgeFingerprint() const {
+    uint32_t crc = 0;
+    vector<uint8_t> row;
+    for (int u = 0; u < vertices; ++u) {
+        row.clear();
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u < v) {
+                for (uint32_t word : {static_cast<uint32_t>(u), static_cast<uint32_t>(v), static_cast<uint32_t>(adjMatrix[u][v])}) {
+                    for (int i = 0; i < 4; ++i) {
+                        row.push_back(static_cast<uint8_t>(word >> (8 * i)));
+                    }
+                }
+            }
+        });
+        crc = crc32Update(crc, row.data(), row.size());
+    }
+    return crc;
+}
+
+int Graph::getEdges() const {
+    return static_cast<int>(summary.edgeCount()) - 1;
 }
\ No newline at end of file
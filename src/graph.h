@@ -3,33 +3,68 @@
 
 #include <vector>
 #include <string>
+#include "adjacency.h"
+#include "graphSummary.h"
+#include "options.h"
+#include "contractionHierarchy.h"
+#include "compactTour.h"
+#include "eulerCircuit.h"
+#include "graphPartition.h"
+
+struct SolverWorkspace;
+struct GeneticState;
 
 
 class Graph {
 private:
     int vertices;
     std::vector<std::vector<int>> adjMatrix;
+    AdjacencyIndex adjacency;
+    mutable GraphSummary summary;
     int seed;
+    SolverOptions options;
+    HierarchyView hierarchy;
+    std::vector<int> originalIds;  ///< Input number of every vertex after reorderVertices, empty before.
 
 public:
     Graph(int v, double satruation);
     Graph(const std::string& jsonFile);
+    Graph(int v, const std::vector<std::pair<int, int>>& edges);
     void addEdge(int u, int v);
+    void removeEdge(int u, int v);
     int getVertices() const;
     int getEdges() const;
     std::vector<std::pair<int, int>> getOddDegreeVertices() const;
     int getEdgeWeight(int u, int v) const;
     const std::vector<std::vector<int>>& getAdjMatrix() const;
+    const AdjacencyIndex& getAdjacency() const;
+    const GraphSummary& getSummary() const;
     bool isEulerian() const;
     void printAdjMatrix();
     void toGraphviz(const std::string& filename) const;
     
     void setSeed(int seed);
     int getSeed() const;
+    void setOptions(const SolverOptions& options);
+    const SolverOptions& getOptions() const;
+    void setHierarchy(HierarchyView hierarchy);
+    void reorderVertices(VertexOrder order);
+    int originalVertex(int v) const { return originalIds.empty() ? v : originalIds[v]; }
+    std::vector<WeightedEdge> getWeightedEdges() const;
+    uint32_t edgeFingerprint() const;
 
     void solveChinesePostman(int n);
-    void makeGraphEulerian();
+    CompactRoutes planPostmenRoutes(int n);
+    CompactRoutes solveComponent(int n);
+    CompactRoutes solvePartitioned(int n);
+    CompactRoutes solveSharded(int n);
+    std::vector<GraphShard> shardGraph(int n);
+    void addShardRoute(CompactRoutes& routes, int p, const std::vector<int>& globalIds,
+                       const std::vector<std::pair<int, int>>& steps) const;
+    void expandRoute(const CompactRoutes& routes, int i, std::vector<std::pair<int, int>>& out) const;
+    void makeGraphEulerian(std::vector<std::pair<int, int>>& added, std::vector<std::pair<int, int>>& duplicated);
     std::vector<std::pair<int, int>> findEulerCycle();
+    void findEulerCycle(SolverWorkspace& workspace, const EulerStepSink& emit);
     int calculateCycleCost(const std::vector<std::pair<int, int>>& cycle);
     std::vector<std::pair<int,int>> findEuler();
     std::vector<int> dijkstra(int start);
@@ -37,9 +72,11 @@ public:
 
     std::vector<int> shuffeledVertices(int vertices);
 
-    void solveGenetic(int n, int x);
+    void solveGenetic(int n, int x, GeneticState* resume = nullptr);
     std::pair<int, int> findBestPopulations(std::vector<float> &fitnessScores, std::vector<std::vector<std::vector<int>>> &populations, int n);
-    float testFitness(std::vector<std::vector<int>> route);
+    float testFitness(const std::vector<std::vector<int>>& route);
+
+    void solveAnts(int n, int iterations);
 
 
 };
@@ -51,9 +88,11 @@ public:
 std::vector<int> dijkstra2(int start, int end, const std::vector<std::vector<int>>& adjMatrix, int vertices);
 std::vector<int> dijkstra3(int start, const std::vector<std::vector<int>>& adjMatrix, int vertices);
 std::vector<std::pair<int, int>> reconstructPath(int start, int end, const std::vector<int>& parent);
+void allocatePostmen(const std::vector<long long>& work, int n, std::vector<std::vector<int>>& owners);
 
 std::string getColor(int index);
 int graphViz();
+int graphViz(const std::string& inputFileName, const std::string& outputFileName);
 
 
 #endif // GRAPH_H
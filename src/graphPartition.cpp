@@ -0,0 +1,670 @@
+#include "graphPartition.h"
+#include "graph.h"
+#include "threadPool.h"
+#include "solverWorkspace.h"
+#include "memoryStats.h"
+#include "trace.h"
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+/// One level of the coarsening: a weighted graph and the map to the next coarser level.
+struct Level {
+    vector<int> offset;           ///< Arcs of u are arcs[offset[u] .. offset[u + 1]).
+    vector<pair<int, int>> arcs;  ///< (neighbour, number of merged edges).
+    vector<long long> weight;     ///< Work of the merged vertices.
+    vector<int> coarse;           ///< Vertex of the next coarser level.
+
+    int size() const { return static_cast<int>(weight.size()); }
+};
+
+/**
+ * @brief Merges matched pairs of vertices of fine into the vertices of coarse.
+ *
+ * Vertices are visited in random order; an unmatched vertex is matched with the unmatched
+ * neighbour it shares the most edges with (the lighter one on ties), as long as the pair
+ * weighs at most maxWeight, and stays on its own otherwise.
+ */
+void coarsen(Level& fine, Level& coarse, long long maxWeight, mt19937& rng) {
+    int n = fine.size();
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), rng);
+    vector<int> match(n, -1);
+    for (int u : order) {
+        if (match[u] != -1) {
+            continue;
+        }
+        int best = u;
+        int bestEdges = 0;
+        for (int a = fine.offset[u]; a < fine.offset[u + 1]; ++a) {
+            auto [v, edges] = fine.arcs[a];
+            if (match[v] != -1 || fine.weight[u] + fine.weight[v] > maxWeight) {
+                continue;
+            }
+            if (edges > bestEdges || (edges == bestEdges && fine.weight[v] < fine.weight[best])) {
+                best = v;
+                bestEdges = edges;
+            }
+        }
+        match[u] = best;
+        match[best] = u;
+    }
+
+    fine.coarse.assign(n, -1);
+    vector<int> first;
+    for (int u = 0; u < n; ++u) {
+        if (fine.coarse[u] == -1) {
+            fine.coarse[u] = fine.coarse[match[u]] = static_cast<int>(first.size());
+            first.push_back(u);
+        }
+    }
+    int m = static_cast<int>(first.size());
+    coarse.weight.assign(m, 0);
+    coarse.offset.assign(m + 1, 0);
+    coarse.arcs.clear();
+    vector<int> slot(m, -1);
+    for (int c = 0; c < m; ++c) {
+        int start = static_cast<int>(coarse.arcs.size());
+        coarse.offset[c] = start;
+        int members[2] = {first[c], match[first[c]]};
+        for (int k = 0; k < (members[0] == members[1] ? 1 : 2); ++k) {
+            int x = members[k];
+            coarse.weight[c] += fine.weight[x];
+            for (int a = fine.offset[x]; a < fine.offset[x + 1]; ++a) {
+                auto [v, edges] = fine.arcs[a];
+                int target = fine.coarse[v];
+                if (target == c) {
+                    continue;
+                }
+                if (slot[target] >= start) {
+                    coarse.arcs[slot[target]].second += edges;
+                } else {
+                    slot[target] = static_cast<int>(coarse.arcs.size());
+                    coarse.arcs.emplace_back(target, edges);
+                }
+            }
+        }
+    }
+    coarse.offset[m] = static_cast<int>(coarse.arcs.size());
+}
+
+/**
+ * @brief Returns the last unassigned vertex reached by a BFS from start over unassigned vertices.
+ */
+int pseudoPeripheral(const Level& level, const vector<int>& part, int start, vector<int>& seen, int epoch) {
+    vector<int> queue{start};
+    seen[start] = epoch;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int u = queue[head];
+        for (int a = level.offset[u]; a < level.offset[u + 1]; ++a) {
+            int v = level.arcs[a].first;
+            if (part[v] == -1 && seen[v] != epoch) {
+                seen[v] = epoch;
+                queue.push_back(v);
+            }
+        }
+    }
+    return queue.back();
+}
+
+/**
+ * @brief Grows the parts one after another on the coarsest level.
+ *
+ * A part starts at a pseudo-peripheral unassigned vertex and takes the unassigned vertex
+ * with the most edges into it until it has its share of the work not yet assigned. When
+ * its frontier runs dry (the rest of its component is taken) it continues from another
+ * unassigned vertex. The last part takes whatever is left.
+ */
+vector<int> growParts(const Level& level, int parts) {
+    int n = level.size();
+    vector<int> part(n, -1);
+    vector<long long> gain(n, 0);
+    vector<int> gainOf(n, -1);  ///< Part that gain[v] counts edges into.
+    vector<int> seen(n, -1);
+    long long remaining = accumulate(level.weight.begin(), level.weight.end(), 0LL);
+    int lowest = 0;
+    for (int p = 0; p < parts; ++p) {
+        long long goal = p + 1 == parts ? numeric_limits<long long>::max() : remaining / (parts - p);
+        long long load = 0;
+        priority_queue<pair<long long, int>> frontier;
+        while (load < goal) {
+            if (frontier.empty()) {
+                while (lowest < n && part[lowest] != -1) {
+                    ++lowest;
+                }
+                if (lowest == n) {
+                    break;
+                }
+                int start = pseudoPeripheral(level, part, lowest, seen, p);
+                gain[start] = 0;
+                gainOf[start] = p;
+                frontier.emplace(0, start);
+            }
+            auto [g, u] = frontier.top();
+            frontier.pop();
+            if (part[u] != -1 || gainOf[u] != p || g != gain[u]) {
+                continue;
+            }
+            part[u] = p;
+            load += level.weight[u];
+            for (int a = level.offset[u]; a < level.offset[u + 1]; ++a) {
+                auto [v, edges] = level.arcs[a];
+                if (part[v] != -1) {
+                    continue;
+                }
+                if (gainOf[v] != p) {
+                    gainOf[v] = p;
+                    gain[v] = 0;
+                }
+                gain[v] += edges;
+                frontier.emplace(gain[v], v);
+            }
+        }
+        remaining -= load;
+    }
+    return part;
+}
+
+/**
+ * @brief Moves boundary vertices to neighbouring parts, a few passes over the level.
+ *
+ * A vertex moves to the part it has the most edges into if that cuts more edges than it
+ * adds, or as many while evening the two loads, and the target stays within maxLoad. A
+ * vertex of an overloaded part moves to any lighter neighbouring part, the best connected
+ * one first. No part is emptied.
+ */
+void refine(const Level& level, int parts, vector<int>& part, vector<long long>& load, long long maxLoad) {
+    vector<long long> connection(parts, 0);
+    vector<int> touched;
+    for (int pass = 0; pass < GraphPartitioner::refinePasses; ++pass) {
+        bool moved = false;
+        for (int u = 0; u < level.size(); ++u) {
+            int a = part[u];
+            long long w = level.weight[u];
+            touched.clear();
+            for (int i = level.offset[u]; i < level.offset[u + 1]; ++i) {
+                auto [v, edges] = level.arcs[i];
+                if (connection[part[v]] == 0) {
+                    touched.push_back(part[v]);
+                }
+                connection[part[v]] += edges;
+            }
+            int best = a;
+            long long bestGain = 0;
+            bool overloaded = load[a] > maxLoad;
+            for (int b : touched) {
+                if (b == a || load[a] - w <= 0) {
+                    continue;
+                }
+                long long gain = connection[b] - connection[a];
+                bool evens = load[b] + w < load[a];
+                bool allowed = overloaded ? evens : load[b] + w <= maxLoad && (gain > 0 || (gain == 0 && evens));
+                if (allowed && (best == a || gain > bestGain || (gain == bestGain && load[b] < load[best]))) {
+                    best = b;
+                    bestGain = gain;
+                }
+            }
+            for (int b : touched) {
+                connection[b] = 0;
+            }
+            if (best != a) {
+                part[u] = best;
+                load[a] -= w;
+                load[best] += w;
+                moved = true;
+            }
+        }
+        if (!moved) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Hands every piece of a part but its heaviest to the neighbouring part it has the most edges into.
+ *
+ * Repeats until every part is connected or connectRounds rounds have passed; a piece with
+ * no edge into another part stays.
+ */
+void makeConnected(const Level& level, int parts, vector<int>& part, vector<long long>& load) {
+    int n = level.size();
+    vector<int> piece(n);
+    vector<int> members;
+    vector<int> pieceBegin;
+    vector<long long> pieceWeight;
+    vector<long long> connection(parts, 0);
+    vector<int> touched;
+    for (int round = 0; round < GraphPartitioner::connectRounds; ++round) {
+        fill(piece.begin(), piece.end(), -1);
+        members.clear();
+        pieceBegin.clear();
+        pieceWeight.clear();
+        for (int s = 0; s < n; ++s) {
+            if (piece[s] != -1) {
+                continue;
+            }
+            int id = static_cast<int>(pieceBegin.size());
+            pieceBegin.push_back(static_cast<int>(members.size()));
+            pieceWeight.push_back(0);
+            piece[s] = id;
+            members.push_back(s);
+            for (size_t head = pieceBegin[id]; head < members.size(); ++head) {
+                int u = members[head];
+                pieceWeight[id] += level.weight[u];
+                for (int a = level.offset[u]; a < level.offset[u + 1]; ++a) {
+                    int v = level.arcs[a].first;
+                    if (piece[v] == -1 && part[v] == part[u]) {
+                        piece[v] = id;
+                        members.push_back(v);
+                    }
+                }
+            }
+        }
+        pieceBegin.push_back(static_cast<int>(members.size()));
+
+        int pieces = static_cast<int>(pieceWeight.size());
+        vector<int> heaviest(parts, -1);
+        for (int id = 0; id < pieces; ++id) {
+            int p = part[members[pieceBegin[id]]];
+            if (heaviest[p] == -1 || pieceWeight[id] > pieceWeight[heaviest[p]]) {
+                heaviest[p] = id;
+            }
+        }
+        bool moved = false;
+        for (int id = 0; id < pieces; ++id) {
+            int p = part[members[pieceBegin[id]]];
+            if (id == heaviest[p]) {
+                continue;
+            }
+            touched.clear();
+            for (int k = pieceBegin[id]; k < pieceBegin[id + 1]; ++k) {
+                int u = members[k];
+                for (int a = level.offset[u]; a < level.offset[u + 1]; ++a) {
+                    auto [v, edges] = level.arcs[a];
+                    if (part[v] != p) {
+                        if (connection[part[v]] == 0) {
+                            touched.push_back(part[v]);
+                        }
+                        connection[part[v]] += edges;
+                    }
+                }
+            }
+            int target = -1;
+            for (int b : touched) {
+                if (target == -1 || connection[b] > connection[target]) {
+                    target = b;
+                }
+            }
+            for (int b : touched) {
+                connection[b] = 0;
+            }
+            if (target == -1) {
+                continue;
+            }
+            for (int k = pieceBegin[id]; k < pieceBegin[id + 1]; ++k) {
+                part[members[k]] = target;
+            }
+            load[p] -= pieceWeight[id];
+            load[target] += pieceWeight[id];
+            moved = true;
+        }
+        if (!moved) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Numbers the endpoints of edges in increasing order.
+ *
+ * @param globalIds Receives the endpoints, sorted.
+ * @param local Receives the edges with their endpoints' positions in globalIds.
+ * @return The number of connected pieces the edges form.
+ */
+int localize(const vector<pair<int, int>>& edges, vector<int>& globalIds, vector<pair<int, int>>& local) {
+    globalIds.clear();
+    for (const auto& [u, v] : edges) {
+        globalIds.push_back(u);
+        globalIds.push_back(v);
+    }
+    sort(globalIds.begin(), globalIds.end());
+    globalIds.erase(unique(globalIds.begin(), globalIds.end()), globalIds.end());
+    auto localOf = [&globalIds](int x) { return static_cast<int>(lower_bound(globalIds.begin(), globalIds.end(), x) - globalIds.begin()); };
+
+    local.clear();
+    vector<int> root(globalIds.size());
+    iota(root.begin(), root.end(), 0);
+    auto find = [&root](int x) {
+        while (root[x] != x) {
+            x = root[x] = root[root[x]];
+        }
+        return x;
+    };
+    int pieces = static_cast<int>(globalIds.size());
+    for (const auto& [u, v] : edges) {
+        local.emplace_back(localOf(u), localOf(v));
+        int a = find(local.back().first);
+        int b = find(local.back().second);
+        if (a != b) {
+            root[a] = b;
+            pieces--;
+        }
+    }
+    return pieces;
+}
+
+}  // namespace
+
+/**
+ * @brief Adds to edges the edges of shortest paths that join its pieces.
+ *
+ * Every other piece is joined to the piece of the first edge by a breadth-first search
+ * over the whole graph from that piece, which stops at the first vertex of another piece.
+ * The path runs over vertices outside the part, so its edges are new. Pieces in other
+ * components of the graph stay apart.
+ *
+ * @param adjacency The whole graph.
+ * @param vertices The number of vertices of the whole graph.
+ * @param edges The edges of the part; receives the joining paths. Must not be empty.
+ */
+void stitchPieces(const AdjacencyIndex& adjacency, int vertices, vector<pair<int, int>>& edges) {
+    vector<int> root(vertices, -1);
+    auto find = [&root](int x) {
+        while (root[x] != x) {
+            x = root[x] = root[root[x]];
+        }
+        return x;
+    };
+    auto join = [&](int u, int v) {
+        for (int x : {u, v}) {
+            if (root[x] == -1) {
+                root[x] = x;
+            }
+        }
+        root[find(u)] = find(v);
+    };
+    for (const auto& [u, v] : edges) {
+        join(u, v);
+    }
+
+    vector<int> parent(vertices);
+    vector<int> seen(vertices, -1);
+    vector<int> queue;
+    for (int search = 0;; ++search) {
+        int main = find(edges[0].first);
+        queue.clear();
+        for (int u = 0; u < vertices; ++u) {
+            if (root[u] != -1 && find(u) == main) {
+                seen[u] = search;
+                queue.push_back(u);
+            }
+        }
+        int found = -1;
+        for (size_t head = 0; head < queue.size() && found == -1; ++head) {
+            int u = queue[head];
+            adjacency.forEachNeighbour(u, [&](int v) {
+                if (found != -1 || seen[v] == search) {
+                    return;
+                }
+                seen[v] = search;
+                parent[v] = u;
+                if (root[v] != -1) {
+                    found = v;
+                } else {
+                    queue.push_back(v);
+                }
+            });
+        }
+        if (found == -1) {
+            return;
+        }
+        // Only the first piece and vertices outside every piece are searched, so the path
+        // ends at the first vertex that already belongs to a piece.
+        for (int v = found;; v = parent[v]) {
+            bool reached = root[parent[v]] != -1;
+            edges.emplace_back(parent[v], v);
+            join(parent[v], v);
+            if (reached) {
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Builds the neighbour lists.
+ */
+GraphPartitioner::GraphPartitioner(int vertices, const vector<pair<int, int>>& edges)
+    : vertices(vertices), offset(vertices + 1, 0), neighbour(2 * edges.size()) {
+    for (const auto& [u, v] : edges) {
+        offset[u + 1]++;
+        offset[v + 1]++;
+    }
+    partial_sum(offset.begin(), offset.end(), offset.begin());
+    vector<int> fill(offset.begin(), offset.end() - 1);
+    for (const auto& [u, v] : edges) {
+        neighbour[fill[u]++] = v;
+        neighbour[fill[v]++] = u;
+    }
+}
+
+/**
+ * @brief Partitions the vertices into parts.
+ *
+ * @param parts The number of parts.
+ * @param seed Seed of the matching order.
+ * @return The part of every vertex.
+ */
+vector<int> GraphPartitioner::partition(int parts, uint32_t seed) const {
+    vector<Level> levels(1);
+    Level& finest = levels[0];
+    finest.offset = offset;
+    finest.arcs.reserve(neighbour.size());
+    for (int v : neighbour) {
+        finest.arcs.emplace_back(v, 1);
+    }
+    finest.weight.resize(vertices);
+    for (int u = 0; u < vertices; ++u) {
+        finest.weight[u] = offset[u + 1] - offset[u];
+    }
+    long long total = static_cast<long long>(neighbour.size());
+
+    mt19937 rng(seed);
+    long long maxMerged = max(2LL, 3 * total / (static_cast<long long>(coarsestPerPart) * parts));
+    while (levels.back().size() > coarsestPerPart * parts) {
+        Level coarse;
+        coarsen(levels.back(), coarse, maxMerged, rng);
+        if (coarse.size() > levels.back().size() * 0.95) {
+            break;
+        }
+        levels.push_back(move(coarse));
+    }
+
+    vector<int> part = growParts(levels.back(), parts);
+    vector<long long> load(parts, 0);
+    for (int u = 0; u < levels.back().size(); ++u) {
+        load[part[u]] += levels.back().weight[u];
+    }
+    long long maxLoad = static_cast<long long>((1.0 + imbalance) * static_cast<double>(total) / parts) + 1;
+    refine(levels.back(), parts, part, load, maxLoad);
+    for (int l = static_cast<int>(levels.size()) - 2; l >= 0; --l) {
+        vector<int> finer(levels[l].size());
+        for (int u = 0; u < levels[l].size(); ++u) {
+            finer[u] = part[levels[l].coarse[u]];
+        }
+        part = move(finer);
+        refine(levels[l], parts, part, load, maxLoad);
+    }
+    makeConnected(levels[0], parts, part, load);
+    return part;
+}
+
+/**
+ * @brief Solves a connected graph with one postman and returns its closed walk.
+ *
+ * This is all a part (or a shard in a worker process) needs: the walk is expanded here,
+ * as the graph of the part is gone by the time the results are written.
+ *
+ * @param vertices The number of vertices of the part.
+ * @param edges The edges of the part, forming one connected piece.
+ * @param options Options of the whole run.
+ * @param seed Seed of the whole run.
+ * @return The steps of the walk.
+ */
+vector<pair<int, int>> solveShard(int vertices, const vector<pair<int, int>>& edges, const SolverOptions& options, int seed) {
+    vector<pair<int, int>> steps;
+    if (edges.empty()) {
+        return steps;
+    }
+    Graph part(vertices, edges);
+    part.setSeed(seed);
+    SolverOptions own = options;
+    own.partition = false;
+    own.workers = 0;
+    part.setOptions(own);
+    CompactRoutes solved = part.solveComponent(1);
+    part.expandRoute(solved, 0, steps);
+    return steps;
+}
+
+/**
+ * @brief Cuts a connected graph into one shard per postman.
+ *
+ * GraphPartitioner cuts the vertices into n parts. An edge inside a part belongs to that
+ * part. An edge between two parts goes to the one where it makes more of its endpoints'
+ * degrees even, as every odd vertex costs that part's postman deadhead, and on a tie to
+ * the one with less work so far. Where the edges of a part fall apart, shortest paths
+ * through the rest of the graph are stitched in, so every shard can be served in one
+ * closed walk.
+ *
+ * @param n The number of parts.
+ * @return The shards; a part without edges gives an empty shard.
+ */
+vector<GraphShard> Graph::shardGraph(int n) {
+    vector<pair<int, int>> edges;
+    for (int u = 0; u < vertices; ++u) {
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u < v) {
+                edges.emplace_back(u, v);
+            }
+        });
+    }
+
+    vector<vector<pair<int, int>>> partEdges(n);
+    {
+        PhaseScope phase(Phase::Partition);
+        TraceScope trace("partition", n);
+        vector<int> part = GraphPartitioner(vertices, edges).partition(n, static_cast<uint32_t>(seed));
+        vector<long long> work(n, 0);
+        unordered_map<long long, int> degreeIn;
+        auto odd = [&](int x, int p) { return degreeIn[static_cast<long long>(x) * n + p] & 1; };
+        auto assign = [&](int u, int v, int p) {
+            partEdges[p].emplace_back(u, v);
+            work[p]++;
+            degreeIn[static_cast<long long>(u) * n + p]++;
+            degreeIn[static_cast<long long>(v) * n + p]++;
+        };
+        for (const auto& [u, v] : edges) {
+            if (part[u] == part[v]) {
+                assign(u, v, part[u]);
+            }
+        }
+        for (const auto& [u, v] : edges) {
+            int p = part[u];
+            int q = part[v];
+            if (p == q) {
+                continue;
+            }
+            int evenedP = odd(u, p) + odd(v, p);
+            int evenedQ = odd(u, q) + odd(v, q);
+            assign(u, v, evenedP != evenedQ ? (evenedP > evenedQ ? p : q) : (work[p] <= work[q] ? p : q));
+        }
+    }
+
+    vector<GraphShard> shards(n);
+    ThreadPool pool(min<unsigned>(ThreadPool::defaultThreads(), static_cast<unsigned>(n)));
+    vector<future<void>> done;
+    for (int p = 0; p < n; ++p) {
+        done.push_back(pool.submit([this, &own = partEdges[p], &shard = shards[p]]() {
+            if (localize(own, shard.globalIds, shard.edges) > 1) {
+                stitchPieces(adjacency, vertices, own);
+                localize(own, shard.globalIds, shard.edges);
+            }
+        }));
+    }
+    for (auto& f : done) {
+        f.get();
+    }
+    return shards;
+}
+
+/**
+ * @brief Solves the k-postman problem on a connected graph by partitioning it first (--partition).
+ *
+ * The shards of shardGraph are solved as graphs of their own with one postman each, on a
+ * thread pool. The contraction hierarchy is not used.
+ *
+ * @param n The number of postmen (parts).
+ * @return One closed walk and route per part.
+ */
+CompactRoutes Graph::solvePartitioned(int n) {
+    vector<GraphShard> shards = shardGraph(n);
+    ThreadPool pool(min<unsigned>(ThreadPool::defaultThreads(), static_cast<unsigned>(n)));
+    vector<future<vector<pair<int, int>>>> solved;
+    for (const GraphShard& shard : shards) {
+        solved.push_back(pool.submit([this, &shard]() {
+            TraceScope trace("part", static_cast<long long>(shard.edges.size()));
+            return solveShard(static_cast<int>(shard.globalIds.size()), shard.edges, options, seed);
+        }));
+    }
+
+    CompactRoutes result;
+    result.routes.resize(n);
+    for (int p = 0; p < n; ++p) {
+        vector<pair<int, int>> steps = solved[p].get();
+        addShardRoute(result, p, shards[p].globalIds, steps);
+    }
+    return result;
+}
+
+/**
+ * @brief Appends the walk of a shard as tour p and the route that runs all of it.
+ *
+ * @param routes The routes being built; tour p is the next one.
+ * @param p The postman of the shard.
+ * @param globalIds Vertex of the whole graph for every vertex of the shard.
+ * @param steps The walk in shard vertices; the tour numbers the edges it walks.
+ */
+void Graph::addShardRoute(CompactRoutes& routes, int p, const vector<int>& globalIds, const vector<pair<int, int>>& steps) const {
+    CompactTour& tour = routes.tours.emplace_back();
+    tour.globalIds = globalIds;
+    vector<pair<int, int>> edges;
+    edges.reserve(steps.size());
+    for (const auto& [u, v] : steps) {
+        edges.push_back(minmax(u, v));
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+    tour.firstEdge.assign(globalIds.size() + 1, 0);
+    for (const auto& [u, v] : edges) {
+        tour.firstEdge[u + 1]++;
+        tour.edgeTo.push_back(v);
+    }
+    partial_sum(tour.firstEdge.begin(), tour.firstEdge.end(), tour.firstEdge.begin());
+    tour.tokens.reserve(steps.size());
+    for (const auto& [u, v] : steps) {
+        tour.addStep(u, v);
+    }
+    if (tour.size() > 0) {
+        routes.routes[p].push_back({p, 0, tour.size()});
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef GRAPH_PARTITION_H
+#define GRAPH_PARTITION_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "options.h"
+
+class AdjacencyIndex;
+
+/**
+ * @file graphPartition.h
+ * @brief Multilevel partitioning of a graph into k connected parts of about equal work.
+ *
+ * The work of a vertex is its degree, so the work of a part is about twice the number of
+ * edges it has to serve. The partition is built in three stages:
+ * - coarsening: heavy-edge matching merges pairs of neighbours, level by level, until
+ *   about coarsestPerPart vertices per part are left or a level shrinks by less than 5%;
+ * - initial partition: on the coarsest graph every part grows from a pseudo-peripheral
+ *   vertex, always taking the vertex most strongly connected to it, until it has its
+ *   share of the remaining work;
+ * - refinement: the partition is projected back level by level, and after each
+ *   projection boundary vertices move to a neighbouring part when that cuts fewer edges
+ *   (or evens the loads) without a part exceeding (1 + imbalance) times the average.
+ *
+ * Finally every part keeps its heaviest connected piece; the other pieces join the
+ * neighbouring part they are most strongly connected to. A piece that touches no other
+ * part (a separate component of the input) stays where it is.
+ */
+class GraphPartitioner {
+public:
+    static constexpr double imbalance = 0.03;
+    static constexpr int coarsestPerPart = 20;
+    static constexpr int refinePasses = 4;
+    static constexpr int connectRounds = 8;
+
+    /**
+     * @param vertices The number of vertices.
+     * @param edges The edges, each listed once.
+     */
+    GraphPartitioner(int vertices, const std::vector<std::pair<int, int>>& edges);
+
+    std::vector<int> partition(int parts, uint32_t seed) const;
+
+private:
+    int vertices;
+    std::vector<int> offset;     ///< Neighbours of u are neighbour[offset[u] .. offset[u + 1]).
+    std::vector<int> neighbour;
+};
+
+/// One part of a partitioned graph as a graph of its own.
+struct GraphShard {
+    std::vector<int> globalIds;              ///< Vertex of the whole graph for every vertex of the shard.
+    std::vector<std::pair<int, int>> edges;  ///< Edges to serve, in shard vertices; one connected piece.
+};
+
+void stitchPieces(const AdjacencyIndex& adjacency, int vertices, std::vector<std::pair<int, int>>& edges);
+
+std::vector<std::pair<int, int>> solveShard(int vertices, const std::vector<std::pair<int, int>>& edges,
+                                            const SolverOptions& options, int seed);
+
+#endif // GRAPH_PARTITION_H
@@ -0,0 +1,141 @@
+#include "graphSummary.h"
+#include "adjacency.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @file graphSummary.cpp
+ * @brief Resets the summary to an edgeless graph with the given number of vertices.
+ *
+ * @param v The number of vertices.
+ */
+void GraphSummary::reset(int v) {
+    vertices = v;
+    edges = 0;
+    weight = 0;
+    degrees.assign(v, 0);
+    odd.clear();
+    oddPosition.assign(v, -1);
+
+    components = v;
+    edgeComponents = 0;
+    stale = false;
+    parent.resize(v);
+    for (int i = 0; i < v; ++i) {
+        parent[i] = i;
+    }
+    rootSize.assign(v, 1);
+    rootEdges.assign(v, 0);
+}
+
+void GraphSummary::toggleOdd(int u) {
+    if (oddPosition[u] == -1) {
+        oddPosition[u] = static_cast<int>(odd.size());
+        odd.push_back(u);
+    } else {
+        int last = odd.back();
+        odd[oddPosition[u]] = last;
+        oddPosition[last] = oddPosition[u];
+        odd.pop_back();
+        oddPosition[u] = -1;
+    }
+}
+
+/**
+ * @brief Records the insertion of edge (u, v).
+ *
+ * Updates both degrees and their parity, the totals, and merges the components of u and v.
+ */
+void GraphSummary::onEdgeAdded(int u, int v, int w) {
+    edges++;
+    weight += w;
+    degrees[u]++;
+    degrees[v]++;
+    toggleOdd(u);
+    toggleOdd(v);
+    if (!stale) {
+        unite(u, v);
+    }
+}
+
+/**
+ * @brief Records the removal of edge (u, v).
+ *
+ * Degrees and totals are updated immediately. A union-find cannot split sets,
+ * so the component information is marked stale and rebuilt on the next request.
+ */
+void GraphSummary::onEdgeRemoved(int u, int v, int w) {
+    edges--;
+    weight -= w;
+    degrees[u]--;
+    degrees[v]--;
+    toggleOdd(u);
+    toggleOdd(v);
+    stale = true;
+}
+
+/**
+ * @brief Returns the odd-degree vertices with their degrees, sorted by vertex.
+ *
+ * Costs O(k log k) for k odd vertices; no pass over the graph is needed.
+ */
+vector<pair<int, int>> GraphSummary::oddDegreeVertices() const {
+    vector<int> sorted = odd;
+    sort(sorted.begin(), sorted.end());
+    vector<pair<int, int>> result;
+    result.reserve(sorted.size());
+    for (int u : sorted) {
+        result.emplace_back(u, degrees[u]);
+    }
+    return result;
+}
+
+int GraphSummary::componentOf(int u) const {
+    while (parent[u] != u) {
+        parent[u] = parent[parent[u]];
+        u = parent[u];
+    }
+    return u;
+}
+
+void GraphSummary::unite(int u, int v) {
+    int a = componentOf(u);
+    int b = componentOf(v);
+    if (a == b) {
+        edgeComponents += rootEdges[a] == 0;
+        rootEdges[a]++;
+        return;
+    }
+    edgeComponents += 1 - (rootEdges[a] > 0) - (rootEdges[b] > 0);
+    if (rootSize[a] < rootSize[b]) {
+        swap(a, b);
+    }
+    parent[b] = a;
+    rootSize[a] += rootSize[b];
+    rootEdges[a] += rootEdges[b] + 1;
+    components--;
+}
+
+/**
+ * @brief Recomputes the union-find from the current edges after a removal.
+ *
+ * @param adjacency The adjacency index holding the graph's current edges.
+ */
+void GraphSummary::rebuildComponents(const AdjacencyIndex& adjacency) {
+    components = vertices;
+    edgeComponents = 0;
+    for (int i = 0; i < vertices; ++i) {
+        parent[i] = i;
+    }
+    rootSize.assign(vertices, 1);
+    rootEdges.assign(vertices, 0);
+    stale = false;
+    for (int u = 0; u < vertices; ++u) {
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u <= v) {
+                unite(u, v);
+            }
+        });
+    }
+}
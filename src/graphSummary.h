@@ -0,0 +1,63 @@
+#ifndef GRAPH_SUMMARY_H
+#define GRAPH_SUMMARY_H
+
+#include <vector>
+#include <utility>
+
+class AdjacencyIndex;
+
+/**
+ * @file graphSummary.h
+ * @brief Running summary of a graph kept up to date on every edge insertion and removal.
+ *
+ * Holds per-vertex degrees, the set of odd-degree vertices, the edge count and total
+ * weight, and a union-find over the vertices with per-component edge counts.
+ * Every query is O(1) (amortized for the union-find) so callers in hot loops do not
+ * have to rescan the adjacency matrix.
+ */
+class GraphSummary {
+public:
+    void reset(int vertices);
+
+    void onEdgeAdded(int u, int v, int weight);
+    void onEdgeRemoved(int u, int v, int weight);
+
+    int degree(int u) const { return degrees[u]; }
+    bool isOdd(int u) const { return oddPosition[u] != -1; }
+    int oddCount() const { return static_cast<int>(odd.size()); }
+    std::vector<std::pair<int, int>> oddDegreeVertices() const;
+
+    long long edgeCount() const { return edges; }
+    long long totalWeight() const { return weight; }
+
+    /// True once a removal may have split a component; rebuildComponents() must run before component queries.
+    bool componentsStale() const { return stale; }
+    void rebuildComponents(const AdjacencyIndex& adjacency);
+
+    int componentOf(int u) const;
+    int componentCount() const { return components; }
+    /// Number of components with at least one edge.
+    int componentsWithEdges() const { return edgeComponents; }
+    long long componentEdges(int u) const { return rootEdges[componentOf(u)]; }
+    int componentVertices(int u) const { return rootSize[componentOf(u)]; }
+
+private:
+    void toggleOdd(int u);
+    void unite(int u, int v);
+
+    int vertices = 0;
+    long long edges = 0;
+    long long weight = 0;
+    std::vector<int> degrees;
+    std::vector<int> odd;
+    std::vector<int> oddPosition;
+
+    int components = 0;
+    int edgeComponents = 0;
+    bool stale = false;
+    mutable std::vector<int> parent;
+    std::vector<int> rootSize;
+    std::vector<long long> rootEdges;
+};
+
+#endif // GRAPH_SUMMARY_H
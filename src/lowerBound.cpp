@@ -0,0 +1,174 @@
+#include "lowerBound.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+using namespace std;
+
+/**
+ * @brief Distance from every odd-degree vertex to the nearest other odd-degree vertex.
+ *
+ * One Dijkstra run from all odd vertices at once labels every vertex with its nearest
+ * source. A shortest path between two sources has to cross an edge (x, y) whose ends carry
+ * different labels, so the smallest dist[x] + w + dist[y] over such edges is the answer
+ * for both labels. Vertices without another odd vertex in their component get infinity.
+ */
+static vector<long long> nearestOddDistances(int vertices, const vector<WeightedEdge>& edges, const vector<int>& odd) {
+    const long long unreachable = numeric_limits<long long>::max();
+    vector<int> offset(vertices + 1, 0);
+    for (const auto& e : edges) {
+        offset[e.u + 1]++;
+        offset[e.v + 1]++;
+    }
+    partial_sum(offset.begin(), offset.end(), offset.begin());
+    vector<pair<int, int>> arcs(2 * edges.size());
+    vector<int> fill(offset.begin(), offset.end() - 1);
+    for (const auto& e : edges) {
+        arcs[fill[e.u]++] = {e.v, e.weight};
+        arcs[fill[e.v]++] = {e.u, e.weight};
+    }
+
+    vector<long long> dist(vertices, unreachable);
+    vector<int> source(vertices, -1);
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<>> heap;
+    for (size_t i = 0; i < odd.size(); ++i) {
+        dist[odd[i]] = 0;
+        source[odd[i]] = static_cast<int>(i);
+        heap.emplace(0, odd[i]);
+    }
+    while (!heap.empty()) {
+        auto [d, x] = heap.top();
+        heap.pop();
+        if (d != dist[x]) {
+            continue;
+        }
+        for (int a = offset[x]; a < offset[x + 1]; ++a) {
+            auto [y, w] = arcs[a];
+            if (d + w < dist[y]) {
+                dist[y] = d + w;
+                source[y] = source[x];
+                heap.emplace(dist[y], y);
+            }
+        }
+    }
+
+    vector<long long> nearest(odd.size(), unreachable);
+    for (const auto& e : edges) {
+        int a = source[e.u], b = source[e.v];
+        if (a == -1 || a == b) {
+            continue;
+        }
+        long long through = dist[e.u] + e.weight + dist[e.v];
+        nearest[a] = min(nearest[a], through);
+        nearest[b] = min(nearest[b], through);
+    }
+    return nearest;
+}
+
+/**
+ * @brief Computes a lower bound on the cost of the longest route of n postmen.
+ *
+ * Deadhead: the traversed edges of n open walks form a multigraph in which only walk
+ * ends can have odd degree, i.e. at most 2n vertices. All other odd vertices of the graph
+ * must therefore receive an extra edge copy, and the copies pair them up along paths of at
+ * least the distance to their nearest odd neighbour. Each path serves two odd vertices, so
+ * half the sum of the (odd - 2n) smallest such distances is a valid bound.
+ *
+ * With fewer postmen than components the solvers give every component to one postman, who
+ * jumps between its components and walks each of them once. Each component then has its
+ * own two walk ends, so its odd vertices are paired within the component, and the postman
+ * with the heaviest component walks at least that component's required and deadhead cost.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The edges with their weights.
+ * @param postmen The number of postmen (n).
+ * @return The parts of the bound and the bound itself in maxRoute.
+ */
+RouteLowerBound minMaxLowerBound(int vertices, const vector<WeightedEdge>& edges, int postmen) {
+    RouteLowerBound bound;
+    vector<int> degree(vertices, 0);
+    for (const auto& e : edges) {
+        bound.requiredCost += e.weight;
+        bound.longestEdge = max<long long>(bound.longestEdge, e.weight);
+        degree[e.u]++;
+        degree[e.v]++;
+    }
+    vector<int> odd;
+    for (int x = 0; x < vertices; ++x) {
+        if (degree[x] % 2 != 0) {
+            odd.push_back(x);
+        }
+    }
+
+    // Components of the vertices with edges, as union-find roots.
+    vector<int> root(vertices);
+    iota(root.begin(), root.end(), 0);
+    auto find = [&root](int x) {
+        while (root[x] != x) {
+            x = root[x] = root[root[x]];
+        }
+        return x;
+    };
+    for (const auto& e : edges) {
+        root[find(e.u)] = find(e.v);
+    }
+    int components = 0;
+    for (int x = 0; x < vertices; ++x) {
+        components += degree[x] > 0 && find(x) == x;
+    }
+
+    // Half the sum of the smallest distances left once `ends` odd vertices are walk ends.
+    auto pairingCost = [](vector<long long>& nearest, long long ends) {
+        long long paired = static_cast<long long>(nearest.size()) - ends;
+        if (paired <= 0) {
+            return 0LL;
+        }
+        nth_element(nearest.begin(), nearest.begin() + (paired - 1), nearest.end());
+        long long sum = 0;
+        for (long long i = 0; i < paired; ++i) {
+            sum += nearest[i];
+        }
+        return (sum + 1) / 2;
+    };
+    long long heaviestComponent = 0;
+    if (postmen >= components) {
+        if (static_cast<long long>(odd.size()) > 2LL * postmen) {
+            vector<long long> nearest = nearestOddDistances(vertices, edges, odd);
+            bound.deadheadCost = pairingCost(nearest, 2LL * postmen);
+        }
+    } else {
+        vector<long long> nearest = nearestOddDistances(vertices, edges, odd);
+        vector<long long> required(vertices, 0);
+        for (const auto& e : edges) {
+            required[find(e.u)] += e.weight;
+        }
+        vector<vector<long long>> nearestOf(vertices);
+        for (size_t i = 0; i < nearest.size(); ++i) {
+            nearestOf[find(odd[i])].push_back(nearest[i]);
+        }
+        for (int c = 0; c < vertices; ++c) {
+            if (required[c] > 0) {
+                long long deadhead = pairingCost(nearestOf[c], 2);
+                bound.deadheadCost += deadhead;
+                heaviestComponent = max(heaviestComponent, required[c] + deadhead);
+            }
+        }
+    }
+
+    long long total = bound.requiredCost + bound.deadheadCost;
+    long long perPostman = postmen > 0 ? (total + postmen - 1) / postmen : total;
+    bound.maxRoute = max({perPostman, bound.longestEdge, heaviestComponent});
+    return bound;
+}
+
+double optimalityGap(long long cost, long long bound) {
+    if (cost <= bound) {
+        return 0.0;
+    }
+    if (bound <= 0) {
+        return numeric_limits<double>::infinity();
+    }
+    return static_cast<double>(cost - bound) / static_cast<double>(bound);
+}
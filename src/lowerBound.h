@@ -0,0 +1,32 @@
+#ifndef LOWER_BOUND_H
+#define LOWER_BOUND_H
+
+#include <vector>
+#include "contractionHierarchy.h"
+
+/**
+ * @file lowerBound.h
+ * @brief Lower bounds on the longest route of a k-postman tour and the optimality gap.
+ *
+ * The solvers minimise the cost of the most expensive route. Every solution traverses
+ * each edge at least once plus some deadhead edges, so the longest of k routes costs at
+ * least (required + deadhead) / k; it also costs at least the heaviest single edge. With
+ * fewer postmen than components every component is walked whole by one postman, so the
+ * bound is taken per component (see minMaxLowerBound).
+ */
+
+struct RouteLowerBound {
+    long long requiredCost = 0;  ///< Sum of all edge weights.
+    long long deadheadCost = 0;  ///< Lower bound on the weight traversed more than once.
+    long long longestEdge = 0;   ///< Weight of the heaviest edge.
+    long long maxRoute = 0;      ///< Lower bound on the cost of the longest route.
+};
+
+RouteLowerBound minMaxLowerBound(int vertices, const std::vector<WeightedEdge>& edges, int postmen);
+
+/**
+ * @brief Relative distance of cost above bound, e.g. 0.05 for 5 %; 0 when the bound is met.
+ */
+double optimalityGap(long long cost, long long bound);
+
+#endif // LOWER_BOUND_H
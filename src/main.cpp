@@ -1,8 +1,16 @@
 #include "graph.h"
+#include "gaCheckpoint.h"
+#include "memoryStats.h"
+#include "shardCoordinator.h"
+#include "trace.h"
 #include <iostream>
 #include <string>
 #include <chrono>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <optional>
 
 int howManyPostmen();
 
@@ -23,6 +31,41 @@ int howManyPostmen();
  *             - argv[1]: Path to the JSON file containing the graph
  *             - argv[2]: Number of postmen
  *             - argv[3]: Seed for random number generation
+ *             Options may appear anywhere after the program name:
+ *             - --quiet: do not print the routes to the console
+ *             - --format json|compact: write results.json (default) or the binary results.cpr
+ *             - --reorder rcm|bfs|degree: renumber the vertices for memory locality before
+ *               solving; results keep the input numbering
+ *             - --ch: expand the tours with a contraction hierarchy, loaded from (or built and
+ *               saved to) "<json file>.ch"
+ *             - --dot file: export the solution colored by postman to a Graphviz DOT file
+ *             - --dot-max-edges N: edge budget of the DOT export (default 100000)
+ *             - --dot-detail aggregate|sample: how a larger export is reduced (default aggregate)
+ *             - --gap P: stop the genetic algorithm once its longest route is within P percent
+ *               of the lower bound (default 0, i.e. only at a proven optimum)
+ *             - --stats: print heap and RSS usage per solver phase at the end (allocation
+ *               counts need a build with -DCPP_TRACK_ALLOCATIONS, see make compile-stats)
+ *             - --anneal-ms T: time budget in milliseconds of the annealing that balances the
+ *               Chinese postman routes, 0 cuts the tour into equal parts (default 100)
+ *             - --partition: partition every component into one connected, balanced part per
+ *               postman and solve the parts in parallel instead of cutting one tour
+ *             - --workers N: partition like --partition, but solve the parts in N local worker
+ *               processes; a part whose worker dies is solved again by a new one
+ *             - --port P: accept workers on port P (default: a free port)
+ *             - --listen ADDRESS: accept workers on this IPv4 address, e.g. 0.0.0.0 so workers
+ *               on other hosts can join (default 127.0.0.1); workers are not authenticated
+ *             - --worker-timeout S: seconds a worker may take for one part before the part is
+ *               given to another worker (default 600)
+ *             - --checkpoint file: write the state of the genetic algorithm to file every
+ *               --checkpoint-every N generations (default 50), in the background
+ *             - --resume file: continue the genetic algorithm from a checkpoint; the graph,
+ *               number of postmen and seed must be those of the checkpointed run
+ *             - --worker host:port: run as a worker of the coordinator at host:port instead
+ *               of solving a graph
+ *             - --aco-iterations N: iterations of the ant colony solver, off unless set (default 0)
+ *             - --aco-ants N: ants per iteration of the ant colony solver (default 8)
+ *             - --trace file: write a per-thread timeline of the solver phases in Chrome
+ *               trace-event format (open in chrome://tracing or ui.perfetto.dev)
  *
  * @return int Exit status of the program.
  *             - 0: Success
@@ -30,41 +73,177 @@ int howManyPostmen();
  *
  * Usage:
  * @code
- * ./main <json file> <number of postmen> <seed>
+ * ./main <json file> <number of postmen> <seed> [--quiet] [--format json|compact] [--reorder rcm|bfs|degree] [--ch]
+ *        [--dot file] [--dot-max-edges N] [--dot-detail aggregate|sample] [--gap P] [--stats] [--trace file]
+ *        [--aco-iterations N] [--aco-ants N] [--anneal-ms T] [--partition] [--workers N] [--port P]
+ *        [--listen ADDRESS] [--worker-timeout S] [--checkpoint file] [--checkpoint-every N] [--resume file]
+ * ./main --worker host:port
  * @endcode
  */
 
-int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <json file>  <number of postmen>  <seed>" << std::endl;
+static int run(int argc, char* argv[]) {
+    SolverOptions options;
+    bool useHierarchy = false;
+    bool stats = false;
+    std::string traceFile;
+    std::string coordinator;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "json") {
+                options.format = OutputFormat::Json;
+            } else if (format == "compact") {
+                options.format = OutputFormat::Compact;
+            } else {
+                std::cerr << "Unknown format: " << format << std::endl;
+                return 1;
+            }
+        } else if (arg == "--reorder" && i + 1 < argc) {
+            std::string order = argv[++i];
+            if (order == "rcm") {
+                options.vertexOrder = VertexOrder::Rcm;
+            } else if (order == "bfs") {
+                options.vertexOrder = VertexOrder::Bfs;
+            } else if (order == "degree") {
+                options.vertexOrder = VertexOrder::Degree;
+            } else {
+                std::cerr << "Unknown vertex order: " << order << std::endl;
+                return 1;
+            }
+        } else if (arg == "--ch") {
+            useHierarchy = true;
+        } else if (arg == "--dot" && i + 1 < argc) {
+            options.dotFile = argv[++i];
+        } else if (arg == "--dot-max-edges" && i + 1 < argc) {
+            options.dotMaxEdges = std::stoull(argv[++i]);
+        } else if (arg == "--dot-detail" && i + 1 < argc) {
+            std::string detail = argv[++i];
+            if (detail == "aggregate") {
+                options.dotDetail = DotDetail::Aggregate;
+            } else if (detail == "sample") {
+                options.dotDetail = DotDetail::Sample;
+            } else {
+                std::cerr << "Unknown DOT detail: " << detail << std::endl;
+                return 1;
+            }
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (arg == "--anneal-ms" && i + 1 < argc) {
+            options.annealMillis = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--aco-iterations" && i + 1 < argc) {
+            options.antIterations = std::stoi(argv[++i]);
+        } else if (arg == "--aco-ants" && i + 1 < argc) {
+            options.ants = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--partition") {
+            options.partition = true;
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.workers = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--port" && i + 1 < argc) {
+            options.port = std::stoi(argv[++i]);
+        } else if (arg == "--listen" && i + 1 < argc) {
+            options.listenAddress = argv[++i];
+        } else if (arg == "--worker-timeout" && i + 1 < argc) {
+            options.workerTimeout = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            options.checkpointFile = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            options.checkpointEvery = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--resume" && i + 1 < argc) {
+            options.resumeFile = argv[++i];
+        } else if (arg == "--worker" && i + 1 < argc) {
+            coordinator = argv[++i];
+        } else if (arg == "--gap" && i + 1 < argc) {
+            options.gapTarget = std::stod(argv[++i]) / 100.0;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (!coordinator.empty()) {
+        return runShardWorker(coordinator);
+    }
+    if (positional.size() != 3) {
+        std::cerr << "Usage: " << argv[0] << " <json file>  <number of postmen>  <seed>  [--quiet]  [--format json|compact]  [--reorder rcm|bfs|degree]  [--ch]  [--dot file]  [--gap P]  [--stats]  [--trace file]  [--aco-iterations N]  [--aco-ants N]  [--anneal-ms T]  [--partition]  [--workers N]  [--port P]  [--listen ADDRESS]  [--worker-timeout S]  [--checkpoint file]  [--checkpoint-every N]  [--resume file]" << std::endl;
         return 1;
     }
 
-    std::string jsonFile = argv[1];
+    std::string jsonFile = positional[0];
+    if (stats) {
+        enableMemoryStats();
+    }
+    if (!traceFile.empty()) {
+        startTracing();
+    }
+    if (useHierarchy) {
+        options.hierarchyFile = jsonFile + ".ch";
+    }
     Graph graph(jsonFile);
+    graph.setOptions(options);
+    if (options.vertexOrder != VertexOrder::Original) {
+        auto reorderStart = std::chrono::high_resolution_clock::now();
+        graph.reorderVertices(options.vertexOrder);
+        std::chrono::duration<double> reorderTime = std::chrono::high_resolution_clock::now() - reorderStart;
+        std::cout << "Vertices reordered in " << reorderTime.count() << " s" << std::endl;
+    }
 
-    int seed = std::stoi(argv[3]);
+    int seed = std::stoi(positional[2]);
     graph.setSeed(seed);
 
-    int numPostmen = std::stoi(argv[2]);
+    int numPostmen = std::stoi(positional[1]);
     if (numPostmen > graph.getEdges()) {
         std::cerr << "Number of postmen cannot be greater than the number of edges." << std::endl;
         return 1;
     }
-    graph.toGraphviz("graph.dot");  
-
+    int components = graph.getSummary().componentsWithEdges();
+    if (numPostmen < components) {
+        std::cerr << "Warning: " << numPostmen << " postmen for " << components << " connected components; a route that "
+                  << "serves more than one component jumps between them and is not a continuous walk." << std::endl;
+    }
     int gen = 500;
+    // Read the checkpoint before any solver runs, so a wrong or damaged one fails at once.
+    std::optional<GeneticState> resume;
+    if (!options.resumeFile.empty()) {
+        resume = readGeneticCheckpoint(options.resumeFile, graph.getVertices(), graph.getSummary().edgeCount(),
+                                       graph.edgeFingerprint(), numPostmen, seed, gen);
+    }
 
 
     
 
+    std::chrono::duration<double> antTime(0);
+    if (options.antIterations > 0) {
+        auto antStart = std::chrono::high_resolution_clock::now();
+        {
+            TraceScope trace("ant colony");
+            graph.solveAnts(numPostmen, options.antIterations);
+        }
+        antTime = std::chrono::high_resolution_clock::now() - antStart;
+    }
+
     auto start = std::chrono::high_resolution_clock::now();
-    graph.solveChinesePostman(numPostmen);
+    {
+        TraceScope trace("chinese postman");
+        graph.solveChinesePostman(numPostmen);
+    }
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> chinesePostmanTime = end - start;
+    if (options.antIterations > 0) {
+        std::cout << "Ant colony solved in " << antTime.count() << " s, Chinese postman in " << chinesePostmanTime.count() << " s" << std::endl;
+    }
 
     start = std::chrono::high_resolution_clock::now();
-    graph.solveGenetic(numPostmen, gen);
+    {
+        TraceScope trace("genetic");
+        graph.solveGenetic(numPostmen, gen, resume ? &*resume : nullptr);
+    }
     end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> geneticTime = end - start;
 
@@ -74,12 +253,36 @@ int main(int argc, char* argv[]) {
 
     if (csvFile.is_open()) {
         // csvFile << graph.getEdges() << "," << chinesePostmanTime.count() << "," << geneticTime.count() << "," << graph.getVertices() << "\n";
-        csvFile << graph.getEdges() << "," << chinesePostmanTime.count() << "," << 0 << "," << graph.getVertices() << "\n";
+        csvFile << graph.getEdges() << "," << chinesePostmanTime.count() << "," << 0 << "," << graph.getVertices() << "," << antTime.count() << "\n";
         csvFile.close();
     } else {
         std::cerr << "Unable to open file wykres.csv" << std::endl;
     }
 
+    if (stats) {
+        writeMemoryStats(std::cout);
+    }
+    if (!traceFile.empty()) {
+        if (writeTrace(traceFile)) {
+            std::cout << "Trace saved to " << traceFile << std::endl;
+        } else {
+            std::cerr << "Unable to open file " << traceFile << " for writing." << std::endl;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs the program; an error that stops it (a busy port, an unreadable checkpoint,
+ *        an invalid number, ...) is printed and exits with status 1.
+ */
+int main(int argc, char* argv[]) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
 }
     
 
@@ -0,0 +1,217 @@
+#include "memoryStats.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+
+using namespace std;
+
+namespace {
+
+struct PhaseCounters {
+    atomic<long long> entered{0};
+    atomic<long long> allocations{0};
+    atomic<long long> bytes{0};
+    atomic<long long> peakLive{0};    ///< Highest live heap while this phase allocated.
+    atomic<long long> rssKb{0};       ///< VmRSS when the phase last ended.
+    atomic<long long> peakRssKb{0};   ///< VmHWM when the phase last ended.
+};
+
+const char* const phaseNames[] = {"other", "load", "reorder", "eulerize", "euler tour", "expansion", "split", "genetic", "ant colony", "partition"};
+static_assert(sizeof(phaseNames) / sizeof(phaseNames[0]) == static_cast<size_t>(Phase::Count), "one name per phase");
+
+PhaseCounters counters[static_cast<int>(Phase::Count)];
+atomic<long long> liveBytes{0};
+atomic<bool> statsEnabled{false};
+thread_local Phase currentPhase = Phase::Other;
+
+void raiseTo(atomic<long long>& value, long long candidate) {
+    long long seen = value.load(memory_order_relaxed);
+    while (candidate > seen && !value.compare_exchange_weak(seen, candidate, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Reads VmHWM and VmRSS (in KiB) from /proc/self/status; both stay 0 where unavailable.
+ */
+void readRss(long long& peakKb, long long& currentKb) {
+    peakKb = currentKb = 0;
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status) {
+        return;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            peakKb = atoll(line + 6);
+        } else if (strncmp(line, "VmRSS:", 6) == 0) {
+            currentKb = atoll(line + 6);
+        }
+    }
+    fclose(status);
+}
+
+#ifdef CPP_TRACK_ALLOCATIONS
+const size_t header = alignof(max_align_t);
+
+void noteAllocation(size_t size) {
+    PhaseCounters& phase = counters[static_cast<int>(currentPhase)];
+    phase.allocations.fetch_add(1, memory_order_relaxed);
+    phase.bytes.fetch_add(static_cast<long long>(size), memory_order_relaxed);
+    long long live = liveBytes.fetch_add(static_cast<long long>(size), memory_order_relaxed) + static_cast<long long>(size);
+    raiseTo(phase.peakLive, live);
+}
+
+/// Allocates size bytes behind a header that remembers the size for operator delete.
+void* allocate(size_t size) {
+    void* base = malloc(size + header);
+    if (!base) {
+        return nullptr;
+    }
+    *static_cast<size_t*>(base) = size;
+    noteAllocation(size);
+    return static_cast<char*>(base) + header;
+}
+
+void release(void* p) {
+    if (!p) {
+        return;
+    }
+    char* base = static_cast<char*>(p) - header;
+    liveBytes.fetch_sub(static_cast<long long>(*reinterpret_cast<size_t*>(base)), memory_order_relaxed);
+    free(base);
+}
+
+/// Over-aligned variant: the header takes a whole alignment unit, the size sits at its end.
+void* allocateAligned(size_t size, size_t alignment) {
+    size_t head = max(alignment, header);
+    size_t total = (head + size + alignment - 1) / alignment * alignment;
+    char* base = static_cast<char*>(aligned_alloc(alignment, total));
+    if (!base) {
+        return nullptr;
+    }
+    *reinterpret_cast<size_t*>(base + head - sizeof(size_t)) = size;
+    noteAllocation(size);
+    return base + head;
+}
+
+void releaseAligned(void* p, size_t alignment) {
+    if (!p) {
+        return;
+    }
+    char* user = static_cast<char*>(p);
+    liveBytes.fetch_sub(static_cast<long long>(*reinterpret_cast<size_t*>(user - sizeof(size_t))), memory_order_relaxed);
+    free(user - max(alignment, header));
+}
+
+void* allocateOrThrow(size_t size) {
+    void* p = allocate(size);
+    if (!p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void* allocateAlignedOrThrow(size_t size, size_t alignment) {
+    void* p = allocateAligned(size, alignment);
+    if (!p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+#endif
+
+} // namespace
+
+#ifdef CPP_TRACK_ALLOCATIONS
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { release(p); }
+
+void* operator new(size_t size, align_val_t a) { return allocateAlignedOrThrow(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, align_val_t a) { return allocateAlignedOrThrow(size, static_cast<size_t>(a)); }
+void* operator new(size_t size, align_val_t a, const nothrow_t&) noexcept { return allocateAligned(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, align_val_t a, const nothrow_t&) noexcept { return allocateAligned(size, static_cast<size_t>(a)); }
+void operator delete(void* p, align_val_t a) noexcept { releaseAligned(p, static_cast<size_t>(a)); }
+void operator delete[](void* p, align_val_t a) noexcept { releaseAligned(p, static_cast<size_t>(a)); }
+void operator delete(void* p, size_t, align_val_t a) noexcept { releaseAligned(p, static_cast<size_t>(a)); }
+void operator delete[](void* p, size_t, align_val_t a) noexcept { releaseAligned(p, static_cast<size_t>(a)); }
+void operator delete(void* p, align_val_t a, const nothrow_t&) noexcept { releaseAligned(p, static_cast<size_t>(a)); }
+void operator delete[](void* p, align_val_t a, const nothrow_t&) noexcept { releaseAligned(p, static_cast<size_t>(a)); }
+#endif
+
+PhaseScope::PhaseScope(Phase phase) : previous(currentPhase) {
+    currentPhase = phase;
+    if (statsEnabled.load(memory_order_relaxed)) {
+        counters[static_cast<int>(phase)].entered.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Samples the RSS for the phase that ends and restores the enclosing phase.
+ */
+PhaseScope::~PhaseScope() {
+    if (statsEnabled.load(memory_order_relaxed)) {
+        long long peakKb, currentKb;
+        readRss(peakKb, currentKb);
+        PhaseCounters& phase = counters[static_cast<int>(currentPhase)];
+        phase.rssKb.store(currentKb, memory_order_relaxed);
+        raiseTo(phase.peakRssKb, peakKb);
+    }
+    currentPhase = previous;
+}
+
+/**
+ * @brief Turns on the RSS sampling at phase boundaries (--stats).
+ */
+void enableMemoryStats() {
+    statsEnabled.store(true, memory_order_relaxed);
+}
+
+bool allocationTrackingCompiled() {
+#ifdef CPP_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Prints one line per phase that was entered or allocated, sizes in MiB.
+ */
+void writeMemoryStats(ostream& out) {
+    const double mib = 1024.0 * 1024.0;
+    bool tracked = allocationTrackingCompiled();
+    out << "Memory by phase" << (tracked ? "" : " (allocation counts need make compile-stats)") << ":\n";
+    out << left << setw(12) << "phase" << right << setw(9) << "entered" << setw(13) << "allocations" << setw(12)
+        << "MiB alloc" << setw(12) << "peak heap" << setw(10) << "RSS end" << setw(10) << "peak RSS" << '\n';
+    out << fixed << setprecision(1);
+    for (int p = 0; p < static_cast<int>(Phase::Count); ++p) {
+        const PhaseCounters& phase = counters[p];
+        long long entered = phase.entered.load();
+        long long allocations = phase.allocations.load();
+        if (entered == 0 && allocations == 0) {
+            continue;
+        }
+        out << left << setw(12) << phaseNames[p] << right << setw(9) << entered;
+        if (tracked) {
+            out << setw(13) << allocations << setw(12) << phase.bytes.load() / mib << setw(12) << phase.peakLive.load() / mib;
+        } else {
+            out << setw(13) << "-" << setw(12) << "-" << setw(12) << "-";
+        }
+        out << setw(10) << phase.rssKb.load() / 1024.0 << setw(10) << phase.peakRssKb.load() / 1024.0 << '\n';
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6);
+}
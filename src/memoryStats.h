@@ -0,0 +1,52 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <ostream>
+
+/**
+ * @file memoryStats.h
+ * @brief Heap and RSS accounting per solver phase (--stats).
+ *
+ * A PhaseScope names the phase the calling thread is in. When the program is built with
+ * -DCPP_TRACK_ALLOCATIONS (make compile-stats), global operator new/delete are replaced
+ * and every allocation is charged to the allocating thread's phase: bytes, count and the
+ * highest live heap seen while the phase allocated. Independently of the build flag, the
+ * peak and current RSS are read from /proc/self/status whenever a phase ends.
+ */
+
+enum class Phase {
+    Other,      ///< Anything outside a named phase.
+    Load,       ///< Reading the graph file.
+    Reorder,    ///< --reorder.
+    Eulerize,   ///< Pairing odd vertices (Graph::makeGraphEulerian).
+    EulerTour,  ///< Building the Euler circuit as edge and path tokens, or the whole closed walk of small graphs.
+    Expansion,  ///< Building the DistanceTable the circuit's paths are costed from, and expanding them on output.
+    Split,      ///< Cutting the walk into routes.
+    Genetic,    ///< The generations of the genetic algorithm.
+    Ants,       ///< The ant colony solver.
+    Partition,  ///< Partitioning the graph for --partition.
+    Count
+};
+
+/**
+ * @brief Charges the calling thread's allocations to phase until destroyed.
+ *
+ * Scopes nest; the enclosing phase is restored on destruction.
+ */
+class PhaseScope {
+public:
+    explicit PhaseScope(Phase phase);
+    ~PhaseScope();
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+    Phase previous;
+};
+
+void enableMemoryStats();
+bool allocationTrackingCompiled();
+void writeMemoryStats(std::ostream& out);
+
+#endif // MEMORY_STATS_H
@@ -0,0 +1,52 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @file options.h
+ * @brief Command-line switches shared by the solvers.
+ */
+enum class OutputFormat {
+    Json,     ///< results.json with [u, v] pairs per route.
+    Compact   ///< Delta/varint coded vertex walks in a checksummed binary container (--format compact).
+};
+
+/// How a DOT export larger than its edge budget is reduced.
+enum class DotDetail {
+    Aggregate,  ///< Merge vertices into groups and draw one weighted edge per pair of groups.
+    Sample      ///< Keep every k-th edge.
+};
+
+/// Vertex numbering used inside the solvers (--reorder); results always use the input numbering.
+enum class VertexOrder {
+    Original,  ///< As listed in the input file.
+    Rcm,       ///< Reverse Cuthill-McKee.
+    Bfs,       ///< Breadth-first.
+    Degree     ///< Decreasing degree.
+};
+
+struct SolverOptions {
+    bool quiet = false;  ///< Do not print the routes to the console (--quiet).
+    OutputFormat format = OutputFormat::Json;
+    VertexOrder vertexOrder = VertexOrder::Original;
+    std::string dotFile;                    ///< Export the solution colored by postman to this DOT file (--dot).
+    std::size_t dotMaxEdges = 100000;       ///< Edge budget of the DOT export (--dot-max-edges).
+    std::string hierarchyFile;              ///< Load or build a contraction hierarchy here for path expansion (--ch).
+    DotDetail dotDetail = DotDetail::Aggregate;  ///< Reduction used above the budget (--dot-detail).
+    double gapTarget = 0.0;                 ///< Stop the genetic search once within this fraction of the lower bound (--gap).
+    int antIterations = 0;                  ///< Iterations of the ant colony solver, 0 skips it (--aco-iterations).
+    int ants = 8;                           ///< Ants per iteration (--aco-ants).
+    int annealMillis = 100;                 ///< Time budget of the route balancer per component, 0 splits evenly (--anneal-ms).
+    bool partition = false;                 ///< Partition every component into one part per postman before routing (--partition).
+    int workers = 0;                        ///< Solve the parts in this many local worker processes, 0 in this one (--workers).
+    int port = 0;                           ///< Port the coordinator accepts workers on, 0 for any free port (--port).
+    std::string listenAddress = "127.0.0.1";  ///< IPv4 address the coordinator accepts workers on (--listen).
+    int workerTimeout = 600;                ///< Seconds a worker has for one shard before it is dropped (--worker-timeout).
+    std::string checkpointFile;             ///< Checkpoint the genetic search to this file (--checkpoint).
+    int checkpointEvery = 50;               ///< Generations between checkpoints (--checkpoint-every).
+    std::string resumeFile;                 ///< Continue the genetic search from this checkpoint (--resume).
+};
+
+#endif // OPTIONS_H
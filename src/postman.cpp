@@ -6,121 +6,500 @@
 #include <stdexcept>
 #include <limits>
 #include <fstream>
-#include <nlohmann/json.hpp> 
 #include <utility>
+#include <future>
+#include <memory>
+#include "threadPool.h"
+#include "eulerCircuit.h"
+#include "resultWriter.h"
+#include "dotExport.h"
+#include "solverWorkspace.h"
+#include "contractionHierarchy.h"
+#include "floydWarshall.h"
+#include "lowerBound.h"
+#include "memoryStats.h"
+#include "trace.h"
+#include "smallGraph.h"
+#include "routeAnnealer.h"
+#include <chrono>
 
 
-using json = nlohmann::json;
 using namespace std;
 
+/**
+ * @brief Loads the contraction hierarchy of the graph from path, or builds and saves it.
+ *
+ * A saved hierarchy is used only when its fingerprint matches the graph; otherwise (or if
+ * the file is unreadable) it is rebuilt and written back to path.
+ */
+static shared_ptr<const ContractionHierarchy> prepareHierarchy(const Graph& graph, const string& path) {
+    vector<WeightedEdge> edges = graph.getWeightedEdges();
+    uint32_t fingerprint = ContractionHierarchy::fingerprint(graph.getVertices(), edges);
+    auto hierarchy = make_shared<ContractionHierarchy>();
+    try {
+        if (ContractionHierarchy::load(path, *hierarchy) && hierarchy->getFingerprint() == fingerprint &&
+            hierarchy->getVertices() == graph.getVertices()) {
+            cout << "Contraction hierarchy loaded from " << path << endl;
+            return hierarchy;
+        }
+    } catch (const std::exception& ex) {
+        cerr << ex.what() << endl;
+    }
+
+    auto start = chrono::steady_clock::now();
+    *hierarchy = ContractionHierarchy::build(graph.getVertices(), edges);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Contraction hierarchy built in " << elapsed.count() << " s (" << hierarchy->shortcutCount() << " shortcuts)";
+    if (hierarchy->save(path)) {
+        cout << ", saved to " << path;
+    }
+    cout << endl;
+    return hierarchy;
+}
+
 /**
  * @file graph.cpp
  * @brief Solves the Chinese Postman Problem for the given graph.
  * 
- * This function makes the graph Eulerian, finds an Euler cycle, and then 
- * distributes the edges of the cycle among the given number of postmen. 
- * It calculates the total cost of the routes and saves the results in a JSON file.
+ * This function plans the routes of all postmen (see planPostmenRoutes), 
+ * prints them together with their total cost and streams the results to a JSON file.
  * 
  * @param n The number of postmen.
  * 
  * The function performs the following steps:
- * 1. Copies the adjacency matrix to a local variable.
- * 2. Makes the graph Eulerian by adding necessary edges.
- * 3. Finds an Euler cycle in the graph.
- * 4. Reconstructs the Euler cycle to ensure all edges are covered.
- * 5. Distributes the edges of the Euler cycle among the postmen.
- * 6. Calculates the total cost of the routes.
- * 7. Prints the routes and total cost.
- * 8. Calculates and prints the accuracy of the solution.
- * 9. Saves the results in a JSON file named "results.json".
+ * 1. Splits the graph into connected components and solves each one (see planPostmenRoutes).
+ *    With --ch the shortest paths come from a contraction hierarchy (see prepareHierarchy).
+ * 2. Expands one route at a time (see expandRoute), takes its cost from the tokens and maps
+ *    it back to the input vertex numbers if the graph was reordered (see reorderVertices).
+ * 3. Prints the routes (unless the quiet option is set) and the total cost.
+ * 4. Prints the longest route against a lower bound (see minMaxLowerBound) and the gap.
+ * 5. Writes the results to "results.json" (or "results.cpr" in the compact format) edge by edge.
+ * 6. Exports the routes colored by postman to the DOT file given with --dot, if any.
  * 
- * The JSON file contains:
+ * The results file contains:
  * - The routes for each postman.
  * - The cost of each postman's route.
  * - The total cost of all routes.
- * 
- * @note The function assumes that the graph is connected and all vertices have even degree.
  */
 void Graph::solveChinesePostman(int n) {
-    vector<vector<int>> localAdjMatrix = adjMatrix;
-    makeGraphEulerian();
-    auto eulerCycle = findEulerCycle();
-    vector<pair<int,int>> eulerCycle2;
+    if (!options.hierarchyFile.empty()) {
+        setHierarchy({prepareHierarchy(*this, options.hierarchyFile), {}, nullptr});
+    }
+    RouteLowerBound bound;
+    {
+        TraceScope trace("lower bound");
+        bound = minMaxLowerBound(vertices, getWeightedEdges(), n);
+    }
+    CompactRoutes postmenRoutes;
+    {
+        TraceScope trace("plan routes");
+        postmenRoutes = planPostmenRoutes(n);
+    }
+
+    TraceScope trace("write results");
 
-    for (const auto& edge : eulerCycle) {
-        if (localAdjMatrix[edge.second][edge.first] == 1){
-            eulerCycle2.push_back({edge.second, edge.first});
-            
+    string outputPath = resultPath("results", options.format);
+    unique_ptr<RouteWriter> writer = openRouteWriter(outputPath, options.format);
+    vector<pair<int, int>> route;
+    vector<vector<pair<int, int>>> dotRoutes(options.dotFile.empty() ? 0 : n);
+    long long totalCost = 0;
+    long long maxCost = 0;
+    for (int i = 0; i < n; ++i) {
+        long long cost = postmenRoutes.cost(i);
+        maxCost = max(maxCost, cost);
+        expandRoute(postmenRoutes, i, route);
+        if (!originalIds.empty()) {
+            for (auto& edge : route) {
+                edge = {originalIds[edge.first], originalIds[edge.second]};
+            }
         }
-        else{
-            auto parent = dijkstra3(edge.second, localAdjMatrix, vertices);
-            auto shortestPath = reconstructPath(edge.second, edge.first, parent);
-            for (const auto& edgePath : shortestPath) {
-                eulerCycle2.push_back({edgePath.first, edgePath.second});
+        if (!options.quiet) {
+            cout << "Postman " << i + 1 << ": ";
+            for (const auto& edge : route) {
+                cout << "(" << edge.first << ", " << edge.second << ") ";
             }
+            cout << '\n';
+        }
+        writer->beginPostman();
+        for (const auto& edge : route) {
+            writer->addEdge(edge.first, edge.second);
+        }
+        writer->endPostman(cost);
+        totalCost += cost;
+        if (!dotRoutes.empty()) {
+            dotRoutes[i] = route;
         }
     }
+    cout << "Total cost: " << totalCost << endl;
+    cout << "Longest route: " << maxCost << ", lower bound: " << bound.maxRoute
+         << " (required " << bound.requiredCost << ", deadhead >= " << bound.deadheadCost << ")" << endl;
+    cout << "Gap: " << optimalityGap(maxCost, bound.maxRoute) * 100 << "%" << endl;
 
-    // cout << "\nEulerEND" << ": ";
-    // for (const auto& edge : eulerCycle2) {
-    //     cout << "(" << edge.first << ", " << edge.second << ") ";
-    // }
-    // cout << endl;
+    if (writer->isOpen() && writer->finish(totalCost)) {
+        cout << "Results saved to " << outputPath << endl;
+    } else {
+        cerr << "Unable to open file for writing." << endl;
+    }
 
-    int totalEdges = eulerCycle2.size();
-    int edgesPerPostman = totalEdges / n;
-    vector<vector<pair<int, int>>> postmenRoutes(n);
+    if (!options.dotFile.empty()) {
+        if (writeDot(options.dotFile, vertices, dotRoutes, options.dotMaxEdges, options.dotDetail)) {
+            cout << "DOT file has been created: " << options.dotFile << endl;
+        } else {
+            cerr << "Unable to open file " << options.dotFile << " for writing." << endl;
+        }
+    }
+}
 
-    auto it = eulerCycle2.begin();
-    for (int i = 0; i < n; ++i) {
-        int count = 0;
-        while (it != eulerCycle2.end() && count < edgesPerPostman) {
-            postmenRoutes[i].push_back(*it);
-            ++it;
-            ++count;
+/**
+ * @brief Distributes postmen over connected components in proportion to their work.
+ *
+ * With at least as many postmen as components every component gets one postman and the
+ * rest are handed out by largest remainder of (edges / total edges). With fewer postmen
+ * than components each component is solved by a single postman and the components are
+ * assigned to postmen greedily, largest first onto the least loaded postman. Such a
+ * postman's route jumps from one component to the next, so it is not a continuous walk;
+ * main warns about this before solving.
+ *
+ * @param work The number of edges in each component.
+ * @param n The number of postmen.
+ * @param owners Receives, for every component, the global postman index of each of its routes.
+ */
+void allocatePostmen(const vector<long long>& work, int n, vector<vector<int>>& owners) {
+    int components = static_cast<int>(work.size());
+    owners.assign(components, {});
+
+    if (n < components) {
+        vector<int> order(components);
+        for (int c = 0; c < components; ++c) {
+            order[c] = c;
+        }
+        stable_sort(order.begin(), order.end(), [&work](int a, int b) { return work[a] > work[b]; });
+        vector<long long> load(n, 0);
+        for (int c : order) {
+            int postman = static_cast<int>(min_element(load.begin(), load.end()) - load.begin());
+            load[postman] += work[c];
+            owners[c].push_back(postman);
         }
+        return;
     }
 
-    while (it != eulerCycle2.end()) {
-        postmenRoutes[n - 1].push_back(*it);
-        ++it;
+    long long totalWork = 0;
+    for (long long w : work) {
+        totalWork += w;
+    }
+    int spare = n - components;
+    vector<int> count(components, 1);
+    vector<pair<long long, int>> remainders;
+    int handedOut = 0;
+    for (int c = 0; c < components; ++c) {
+        long long share = work[c] * spare;
+        count[c] += static_cast<int>(share / totalWork);
+        handedOut += static_cast<int>(share / totalWork);
+        remainders.emplace_back(share % totalWork, c);
+    }
+    stable_sort(remainders.begin(), remainders.end(),
+                [](const pair<long long, int>& a, const pair<long long, int>& b) { return a.first > b.first; });
+    for (int i = 0; handedOut < spare; ++i, ++handedOut) {
+        count[remainders[i].second]++;
     }
 
-    int totalCost = 0;
-    for (int i = 0; i < n; ++i) {
-        cout << "Postman " << i + 1 << ": ";
-        for (const auto& edge : postmenRoutes[i]) {
-            cout << "(" << edge.first << ", " << edge.second << ") ";
+    int next = 0;
+    for (int c = 0; c < components; ++c) {
+        for (int i = 0; i < count[c]; ++i) {
+            owners[c].push_back(next++);
         }
-        cout << endl;
-        totalCost += calculateCycleCost(postmenRoutes[i]);
     }
-    cout << "Total cost: " << totalCost << endl;
-    float accuracy = 1;
-    accuracy = (float)getEdges() / (float)totalCost; 
-    cout << "Accuracy: " << accuracy * 100 <<"%"<< endl;
+}
+
+/**
+ * @brief Plans the routes of n postmen over every connected component of the graph.
+ *
+ * The components come from the union-find in the graph summary, which is built while
+ * the edges are loaded. A connected graph is solved directly. Otherwise every component
+ * that has edges is copied into its own Graph with local vertex numbers, the components
+ * are solved concurrently on a thread pool with a share of the postmen proportional to
+ * their edge count, and the routes are mapped back to the original vertex numbers.
+ *
+ * @param n The number of postmen.
+ * @return One closed walk per component (per part with --partition), each mapped to the
+ *         vertices of this graph by its globalIds, and the token ranges of every postman.
+ */
+CompactRoutes Graph::planPostmenRoutes(int n) {
+    const GraphSummary& info = getSummary();
+
+    vector<int> componentIndex(vertices, -1);
+    vector<int> localId(vertices, -1);
+    vector<vector<int>> members;
+    vector<vector<pair<int, int>>> componentEdges;
+    for (int u = 0; u < vertices; ++u) {
+        if (info.degree(u) == 0) {
+            continue;
+        }
+        int root = info.componentOf(u);
+        if (componentIndex[root] == -1) {
+            componentIndex[root] = static_cast<int>(members.size());
+            members.emplace_back();
+            componentEdges.emplace_back();
+        }
+        int c = componentIndex[root];
+        localId[u] = static_cast<int>(members[c].size());
+        members[c].push_back(u);
+    }
 
-    json result;
+    if (members.size() <= 1) {
+        return solveComponent(n);
+    }
 
+    for (int u = 0; u < vertices; ++u) {
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u < v) {
+                componentEdges[componentIndex[info.componentOf(u)]].emplace_back(localId[u], localId[v]);
+            }
+        });
+    }
+
+    vector<long long> work;
+    for (const auto& edges : componentEdges) {
+        work.push_back(static_cast<long long>(edges.size()));
+    }
+    vector<vector<int>> owners;
+    allocatePostmen(work, n, owners);
+
+    shared_ptr<vector<int>> fromHierarchy;
+    if (hierarchy) {
+        fromHierarchy = make_shared<vector<int>>(hierarchy.hierarchy->getVertices(), -1);
+        for (const auto& component : members) {
+            for (size_t i = 0; i < component.size(); ++i) {
+                (*fromHierarchy)[hierarchy.toGlobal(component[i])] = static_cast<int>(i);
+            }
+        }
+    }
+
+    ThreadPool pool(min<unsigned>(ThreadPool::defaultThreads(), static_cast<unsigned>(members.size())));
+    vector<future<CompactRoutes>> solved;
+    for (size_t c = 0; c < members.size(); ++c) {
+        int postmen = static_cast<int>(owners[c].size());
+        int componentVertices = static_cast<int>(members[c].size());
+        const vector<pair<int, int>>& edges = componentEdges[c];
+        const vector<int>& globalIds = members[c];
+        solved.push_back(pool.submit([this, componentVertices, &edges, postmen, &globalIds, fromHierarchy]() {
+            TraceScope trace("component", componentVertices);
+            Graph component(componentVertices, edges);
+            component.setSeed(seed);
+            component.setOptions(options);
+            if (hierarchy) {
+                vector<int> toHierarchy(globalIds.size());
+                for (size_t i = 0; i < globalIds.size(); ++i) {
+                    toHierarchy[i] = hierarchy.toGlobal(globalIds[i]);
+                }
+                component.setHierarchy({hierarchy.hierarchy, move(toHierarchy), fromHierarchy});
+            }
+            CompactRoutes routes = component.solveComponent(postmen);
+            for (CompactTour& tour : routes.tours) {
+                if (tour.globalIds.empty()) {
+                    tour.globalIds = globalIds;
+                    continue;
+                }
+                for (int& vertex : tour.globalIds) {
+                    vertex = globalIds[vertex];
+                }
+            }
+            return routes;
+        }));
+    }
+
+    CompactRoutes postmenRoutes;
+    postmenRoutes.routes.resize(n);
+    for (size_t c = 0; c < members.size(); ++c) {
+        CompactRoutes routes = solved[c].get();
+        int firstTour = static_cast<int>(postmenRoutes.tours.size());
+        for (CompactTour& tour : routes.tours) {
+            postmenRoutes.tours.push_back(move(tour));
+        }
+        for (size_t i = 0; i < routes.routes.size(); ++i) {
+            for (TokenRange range : routes.routes[i]) {
+                range.tour += firstTour;
+                postmenRoutes.routes[owners[c][i]].push_back(range);
+            }
+        }
+    }
+    return postmenRoutes;
+}
+
+/**
+ * @brief Cuts a closed walk into n consecutive routes of about equal cost at token boundaries;
+ * the last route takes the remainder.
+ */
+static vector<vector<TokenRange>> splitWalk(const CompactTour& tour, int n) {
+    long long totalCost = 0;
+    for (int k = 0; k < tour.size(); ++k) {
+        totalCost += tour.cost(k);
+    }
+    vector<vector<TokenRange>> postmenRoutes(n);
+
+    int begin = 0;
+    long long covered = 0;
     for (int i = 0; i < n; ++i) {
-        json postmanData;
-        for (const auto& edge : postmenRoutes[i]) {
-            postmanData.push_back({edge.first, edge.second});
-        }
-        result["postmen"][i] = {
-            {"routes", postmanData},
-            {"cost", calculateCycleCost(postmenRoutes[i])}
-        };
-        totalCost += calculateCycleCost(postmenRoutes[i]);
-    }
-    result["totalCost"] = totalCost;
-    ofstream file("results.json");
-    if (file.is_open()) {
-        file << result.dump();
-        file.close();
-        cout << "Results saved to results.json" << endl;
-    } else {
-        cerr << "Unable to open file for writing." << endl;
+        long long target = totalCost * (i + 1) / n;
+        int end = begin;
+        while (end < tour.size() && (i == n - 1 || covered + tour.cost(end) <= target)) {
+            covered += tour.cost(end++);
+        }
+        if (end > begin) {
+            postmenRoutes[i].push_back({0, begin, end});
+        }
+        begin = end;
+    }
+    return postmenRoutes;
+}
+
+/**
+ * @brief Splits a closed walk between n postmen.
+ *
+ * With a time budget (--anneal-ms) a RouteAnnealer moves the cut points and drops deadhead
+ * at the route ends; without one the walk is cut into equal parts.
+ */
+static vector<vector<TokenRange>> balancedSplit(const CompactTour& tour, int n, const SolverOptions& options, int seed) {
+    if (options.annealMillis <= 0) {
+        return splitWalk(tour, n);
+    }
+    RouteAnnealer annealer(tour);
+    return annealer.balance(n, options.annealMillis, static_cast<uint32_t>(seed));
+}
+
+/**
+ * @brief Solves the Chinese Postman Problem on a connected graph.
+ * 
+ * This function makes the graph Eulerian, finds an Euler cycle, and then 
+ * distributes the edges of the cycle among the given number of postmen.
+ * 
+ * @param n The number of postmen.
+ * @return The closed walk as one compact tour and the token ranges of every postman.
+ * 
+ * The function performs the following steps:
+ * 1. Pairs the odd vertices (makeGraphEulerian), which leaves the graph as it was given.
+ * 2. Finds an Euler cycle of the graph with the pairs added (findEulerCycle) and compresses
+ *    it into tokens while it is built, so the whole cycle is never held. A step over an
+ *    edge becomes the edge's ID. A step between a pair of non-adjacent vertices becomes a
+ *    reference to a shortest path that only records its cost (from the contraction
+ *    hierarchy if one is set, from an all-pairs DistanceTable on dense graphs with many
+ *    pairs, or from a shortest path tree); the table stays with the walk for expandRoute.
+ * 3. Distributes the tokens of the Euler cycle among the postmen (balancedSplit).
+ * 
+ * Graphs of at most 64 vertices skip steps 1-2: smallClosedWalk builds the closed walk on
+ * register bitmasks and leaves the graph unchanged. It pairs the odd vertices exactly (a
+ * walk of minimum length) up to SmallGraph::maxExactOdd of them and greedily above that.
+ * All temporary buffers come from the calling thread's SolverWorkspace. With --partition
+ * and more than one postman the graph is partitioned first (see solvePartitioned), with
+ * --workers the parts are solved in worker processes (see solveSharded).
+ * 
+ * @note The function assumes that all edges of the graph are in one connected component.
+ */
+CompactRoutes Graph::solveComponent(int n) {
+    if (options.workers > 0 && n > 1) {
+        return solveSharded(n);
+    }
+    if (options.partition && n > 1) {
+        return solvePartitioned(n);
+    }
+    SolverWorkspace& workspace = SolverWorkspace::forThisThread();
+    workspace.reset();
+    vector<pair<int, int>>& path = workspace.walk;
+    CompactRoutes result;
+    CompactTour& tour = result.tours.emplace_back();
+    tour.numberEdges(adjacency, vertices);
+
+    bool small = false;
+    if (vertices <= 64) {
+        PhaseScope phase(Phase::EulerTour);
+        TraceScope trace("small walk", vertices);
+        small = smallClosedWalk(adjacency, vertices, workspace.matching, path);
+    }
+    if (small) {
+        PhaseScope phase(Phase::Split);
+        TraceScope trace("split");
+        for (const auto& [u, v] : path) {
+            tour.addStep(u, v);
+        }
+        result.routes = balancedSplit(tour, n, options, seed);
+        return result;
+    }
+
+    {
+        PhaseScope phase(Phase::Eulerize);
+        TraceScope trace("eulerize");
+        makeGraphEulerian(workspace.added, workspace.duplicated);
+    }
+    shared_ptr<const DistanceTable> table;
+    unsigned threads = ThreadPool::defaultThreads();
+    if (!hierarchy && DistanceTable::worthBuilding(vertices, adjacency.edgeCount(), workspace.added.size(), threads)) {
+        PhaseScope phase(Phase::Expansion);
+        TraceScope trace("distance table", vertices);
+        table = make_shared<const DistanceTable>(DistanceTable::build(adjMatrix, vertices, threads));
+    }
+    {
+        PhaseScope phase(Phase::EulerTour);
+        TraceScope trace("euler tour");
+        tour.tokens.reserve(summary.edgeCount() + workspace.added.size() + workspace.duplicated.size());
+        findEulerCycle(workspace, [&](int s, int t) {
+            if (adjMatrix[s][t] == 1) {
+                tour.addStep(s, t);
+                return;
+            }
+            long long cost = hierarchy ? hierarchy.distance(s, t, workspace.hierarchySearch) : -1;
+            if (cost < 0 && table) {
+                cost = table->distance(s, t);
+            }
+            if (cost < 0) {
+                shortestPathTree(s, t, adjMatrix, adjacency, vertices, workspace);
+                cost = workspace.dist[t];
+            }
+            tour.addPath(s, t, static_cast<int>(cost));
+        });
+    }
+    tour.table = move(table);
+
+    PhaseScope split(Phase::Split);
+    TraceScope splitTrace("split");
+    result.routes = balancedSplit(tour, n, options, seed);
+    return result;
+}
+
+/**
+ * @brief Writes the steps of postman i's route to out, in the vertices of this graph.
+ *
+ * Path tokens are expanded here: from the walk's DistanceTable if it has one, otherwise
+ * from the contraction hierarchy if one is set or from a shortest path tree of this graph,
+ * which must then be the one the walk was mapped to.
+ */
+void Graph::expandRoute(const CompactRoutes& routes, int i, vector<pair<int, int>>& out) const {
+    PhaseScope phase(Phase::Expansion);
+    SolverWorkspace& workspace = SolverWorkspace::forThisThread();
+    out.clear();
+    for (const TokenRange& range : routes.routes[i]) {
+        const CompactTour& tour = routes.tours[range.tour];
+        auto global = [&tour](int v) { return tour.globalIds.empty() ? v : tour.globalIds[v]; };
+        for (int k = range.begin; k < range.end; ++k) {
+            if (!tour.isPath(k)) {
+                auto [u, v] = tour.step(k);
+                out.emplace_back(global(u), global(v));
+                continue;
+            }
+            const PathRef& path = tour.path(k);
+            size_t first = out.size();
+            if (tour.table && tour.table->appendPath(path.from, path.to, out)) {
+                for (size_t p = first; p < out.size(); ++p) {
+                    out[p] = {global(out[p].first), global(out[p].second)};
+                }
+                continue;
+            }
+            int s = global(path.from);
+            int t = global(path.to);
+            if (!(hierarchy && hierarchy.appendPath(s, t, workspace.hierarchySearch, out))) {
+                shortestPathTree(s, t, adjMatrix, adjacency, vertices, workspace);
+                appendPath(s, t, workspace.parent, out);
+            }
+        }
     }
 }
 
@@ -154,14 +533,20 @@ vector<int> Graph::reconstructShortestPath(int start, int end, const vector<int>
 }
 
 /**
- * @brief Converts the graph to an Eulerian graph by adding the minimum number of edges.
+ * @brief Pairs up the odd vertices, so the graph with one extra edge per pair is Eulerian.
  * 
- * This function modifies the graph to make it Eulerian by ensuring all vertices have even degrees.
- * It identifies vertices with odd degrees and pairs them up by adding edges with the minimum cost.
+ * It identifies vertices with odd degrees and pairs them up greedily, preferring partners
+ * that are not adjacent, whose pair is later walked as a shortest path. An odd vertex whose
+ * remaining partners are all its neighbours is paired with one of them by walking their
+ * edge twice; as SmallGraph counts its extra copies, the second copy is recorded in
+ * duplicated. The graph itself is not changed: findEulerCycle walks both lists beside it.
  * 
+ * @param added Receives the pairs of vertices that are not adjacent.
+ * @param duplicated Receives the edges of the graph to walk once more, an edge once per copy.
+ *
  * @throws std::runtime_error if the number of vertices with odd degrees is odd.
  */
-void Graph::makeGraphEulerian() {
+void Graph::makeGraphEulerian(vector<pair<int, int>>& added, vector<pair<int, int>>& duplicated) {
     auto oddVertices = getOddDegreeVertices();
     if (oddVertices.size() % 2 != 0) {
         throw std::runtime_error("Odd number of vertices with odd degree!");
@@ -181,7 +566,11 @@ void Graph::makeGraphEulerian() {
             }
         }
         if (bestV != -1) {
-            addEdge(u, bestV);
+            if (bestCost == 0) {
+                added.emplace_back(u, bestV);
+            } else {
+                duplicated.emplace_back(u, bestV);
+            }
             oddVertices.erase(
                 std::remove_if(oddVertices.begin(), oddVertices.end(),
                                [bestV](const std::pair<int, int>& p) { return p.first == bestV; }),
@@ -201,36 +590,51 @@ int Graph::calculateCycleCost(const std::vector<std::pair<int, int>>& cycle) {
 /**
  * @brief Finds an Eulerian cycle in the graph.
  * 
- * This function uses Hierholzer's algorithm to find an Eulerian cycle in the graph.
- * An Eulerian cycle is a cycle that visits every edge exactly once.
+ * This function collects the edges of the graph into an edge list and runs a linear-time
+ * Hierholzer builder on it. Graphs with at least parallelEulerThreshold edges are handed to
+ * the multi-threaded builder instead, which produces the same circuit for any thread count.
+ * The cycle starts at the first vertex that has an edge.
  * 
- * @return std::vector<std::pair<int, int>> A vector of pairs representing the edges in the Eulerian cycle.
- * Each pair contains two integers representing the vertices connected by the edge.
+ * @return std::vector<std::pair<int, int>> A vector of pairs representing the edges in the Eulerian cycle,
+ * in traversal order. Each pair contains the vertex the edge is entered from and the vertex it leads to.
  */
 std::vector<std::pair<int, int>> Graph::findEulerCycle() {
-    std::vector<std::pair<int, int>> eulerCycle;
-    std::stack<int> stack;
-    std::vector<std::vector<int>> localAdjMatrix = adjMatrix; 
-    stack.push(0); 
-    while (!stack.empty()) {
-        int u = stack.top();
-        bool hasEdge = false;
-
-        for (int v = 0; v < vertices; ++v) {
-            if (localAdjMatrix[u][v] > 0) {
-                localAdjMatrix[u][v]--;
-                localAdjMatrix[v][u]--;
-                stack.push(v);
-                hasEdge = true;
-                break;
-            }
-        }
-        if (!hasEdge) {
-            stack.pop();
-            if (!stack.empty()) {
-                eulerCycle.emplace_back(stack.top(), u);
+    SolverWorkspace workspace;
+    std::vector<std::pair<int, int>> circuit;
+    findEulerCycle(workspace, [&circuit](int from, int to) { circuit.emplace_back(from, to); });
+    return circuit;
+}
+
+/**
+ * @brief findEulerCycle building the edge list in the workspace's buffers and handing the
+ *        steps of the cycle to emit as they are found.
+ *
+ * Besides the graph's own edges the cycle walks one edge for every pair in
+ * workspace.added and workspace.duplicated (see makeGraphEulerian).
+ */
+void Graph::findEulerCycle(SolverWorkspace& workspace, const EulerStepSink& emit) {
+    std::vector<std::pair<int, int>>& edges = workspace.edges;
+    edges.clear();
+    edges.reserve(summary.edgeCount() + workspace.added.size() + workspace.duplicated.size());
+    int start = -1;
+    for (int u = 0; u < vertices; ++u) {
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u <= v) {
+                edges.emplace_back(u, v);
             }
+        });
+        if (start == -1 && summary.degree(u) > 0) {
+            start = u;
         }
     }
-    return eulerCycle;
+    edges.insert(edges.end(), workspace.added.begin(), workspace.added.end());
+    edges.insert(edges.end(), workspace.duplicated.begin(), workspace.duplicated.end());
+    if (start == -1) {
+        return;
+    }
+    if (edges.size() >= parallelEulerThreshold) {
+        eulerCircuitParallel(vertices, edges, start, ThreadPool::defaultThreads(), workspace.euler, emit);
+        return;
+    }
+    eulerCircuitSerial(vertices, edges, start, workspace.euler, emit);
 }
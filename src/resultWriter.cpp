@@ -0,0 +1,171 @@
+#include "resultWriter.h"
+#include "binaryFormat.h"
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @file resultWriter.cpp
+ * @brief Opens (creating or truncating) the file for writing.
+ *
+ * @param path The file to write.
+ * @param bufferSize The number of bytes collected before each write(2).
+ */
+BufferedFile::BufferedFile(const std::string& path, std::size_t bufferSize) : buffer(bufferSize) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+
+BufferedFile::~BufferedFile() {
+    close();
+}
+
+void BufferedFile::write(const char* data, std::size_t size) {
+    if (size > buffer.size() - used) {
+        flush();
+        if (size >= buffer.size()) {
+            std::size_t done = 0;
+            while (fd != -1 && done < size) {
+                ssize_t n = ::write(fd, data + done, size - done);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    failed = true;
+                    return;
+                }
+                done += static_cast<std::size_t>(n);
+            }
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+void BufferedFile::writeNumber(long long value) {
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    write(text, static_cast<std::size_t>(result.ptr - text));
+}
+
+void BufferedFile::writeNumber(double value) {
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    write(text, static_cast<std::size_t>(result.ptr - text));
+}
+
+/**
+ * @brief Writes the buffered bytes to the file descriptor.
+ *
+ * @return false if the file is not open or a write failed.
+ */
+bool BufferedFile::flush() {
+    std::size_t done = 0;
+    while (fd != -1 && done < used) {
+        ssize_t n = ::write(fd, buffer.data() + done, used - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    used = 0;
+    return good();
+}
+
+bool BufferedFile::close() {
+    if (fd == -1) {
+        return false;
+    }
+    bool ok = flush();
+    if (::close(fd) != 0) {
+        ok = false;
+    }
+    fd = -1;
+    return ok;
+}
+
+ResultWriter::ResultWriter(const std::string& path) : file(path) {
+    file.write("{\"postmen\":[", 12);
+}
+
+void ResultWriter::beginPostman() {
+    if (!firstPostman) {
+        file.put(',');
+    }
+    firstPostman = false;
+    firstEdge = true;
+    file.write("{\"routes\":[", 11);
+}
+
+void ResultWriter::addEdge(int u, int v) {
+    if (!firstEdge) {
+        file.put(',');
+    }
+    firstEdge = false;
+    file.put('[');
+    file.writeNumber(static_cast<long long>(u));
+    file.put(',');
+    file.writeNumber(static_cast<long long>(v));
+    file.put(']');
+}
+
+void ResultWriter::endPostman(long long cost) {
+    file.write("],\"cost\":", 9);
+    file.writeNumber(cost);
+    file.put('}');
+}
+
+void ResultWriter::endPostman(double cost) {
+    file.write("],\"cost\":", 9);
+    file.writeNumber(cost);
+    file.put('}');
+}
+
+/**
+ * @brief Closes the postmen array and the file, without a total cost.
+ *
+ * @return false if any write failed.
+ */
+bool ResultWriter::finish() {
+    file.write("]}", 2);
+    return file.close();
+}
+
+/**
+ * @brief Closes the postmen array, writes the total cost and closes the file.
+ *
+ * @return false if any write failed.
+ */
+bool ResultWriter::finish(long long totalCost) {
+    file.write("],\"totalCost\":", 14);
+    file.writeNumber(totalCost);
+    file.put('}');
+    return file.close();
+}
+
+/**
+ * @brief Returns the file name for a results file in the given format.
+ *
+ * @param stem The file name without extension, e.g. "results".
+ * @param format The output format.
+ * @return stem + ".json" or stem + ".cpr".
+ */
+std::string resultPath(const std::string& stem, OutputFormat format) {
+    return stem + (format == OutputFormat::Compact ? ".cpr" : ".json");
+}
+
+/**
+ * @brief Opens a writer for the given output format.
+ *
+ * @param path The file to write.
+ * @param format The output format.
+ * @return The writer; check isOpen() before use.
+ */
+std::unique_ptr<RouteWriter> openRouteWriter(const std::string& path, OutputFormat format) {
+    if (format == OutputFormat::Compact) {
+        return std::make_unique<CompactRouteWriter>(path);
+    }
+    return std::make_unique<ResultWriter>(path);
+}
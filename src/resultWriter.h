@@ -0,0 +1,98 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "options.h"
+
+/**
+ * @file resultWriter.h
+ * @brief Buffered output to a POSIX file descriptor and a streaming writer for results files.
+ */
+
+/**
+ * @brief Write-only file with a fixed-size buffer flushed with write(2).
+ *
+ * Numbers are formatted with std::to_chars straight into the buffer.
+ */
+class BufferedFile {
+public:
+    explicit BufferedFile(const std::string& path, std::size_t bufferSize = std::size_t(1) << 16);
+    ~BufferedFile();
+
+    BufferedFile(const BufferedFile&) = delete;
+    BufferedFile& operator=(const BufferedFile&) = delete;
+
+    bool isOpen() const { return fd != -1; }
+    bool good() const { return fd != -1 && !failed; }
+
+    void write(const char* data, std::size_t size);
+    void write(const std::string& text) { write(text.data(), text.size()); }
+    void put(char c) {
+        if (used == buffer.size()) {
+            flush();
+        }
+        buffer[used++] = c;
+    }
+    void writeNumber(long long value);
+    void writeNumber(double value);
+
+    bool flush();
+    bool close();
+
+private:
+    int fd = -1;
+    bool failed = false;
+    std::vector<char> buffer;
+    std::size_t used = 0;
+};
+
+/**
+ * @brief Destination for a solution, written postman by postman and edge by edge.
+ *
+ * Call beginPostman, addEdge for every traversed edge and endPostman once per postman,
+ * then one of the finish overloads.
+ */
+class RouteWriter {
+public:
+    virtual ~RouteWriter() = default;
+
+    virtual bool isOpen() const = 0;
+    virtual void beginPostman() = 0;
+    virtual void addEdge(int u, int v) = 0;
+    virtual void endPostman(long long cost) = 0;
+    virtual void endPostman(double cost) = 0;
+    virtual bool finish() = 0;
+    virtual bool finish(long long totalCost) = 0;
+};
+
+/**
+ * @brief Streams a solution in the results.json schema without building it in memory.
+ *
+ * Produces {"postmen":[{"routes":[[u,v],...],"cost":c},...],"totalCost":t}.
+ */
+class ResultWriter : public RouteWriter {
+public:
+    explicit ResultWriter(const std::string& path);
+
+    bool isOpen() const override { return file.isOpen(); }
+
+    void beginPostman() override;
+    void addEdge(int u, int v) override;
+    void endPostman(long long cost) override;
+    void endPostman(double cost) override;
+    bool finish() override;
+    bool finish(long long totalCost) override;
+
+private:
+    BufferedFile file;
+    bool firstPostman = true;
+    bool firstEdge = true;
+};
+
+std::string resultPath(const std::string& stem, OutputFormat format);
+std::unique_ptr<RouteWriter> openRouteWriter(const std::string& path, OutputFormat format);
+
+#endif // RESULT_WRITER_H
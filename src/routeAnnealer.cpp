@@ -0,0 +1,236 @@
+#include "routeAnnealer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+/**
+ * @brief Lets the first token of every edge serve it.
+ */
+RouteAnnealer::RouteAnnealer(const CompactTour& tour) : length(tour.size()) {
+    prefix.assign(2 * static_cast<size_t>(length) + 1, 0);
+    for (int i = 0; i < 2 * length; ++i) {
+        prefix[i + 1] = prefix[i] + tour.cost(i < length ? i : i - length);
+    }
+
+    edgeOf.assign(length, -1);
+    servedAt.assign(tour.edgeTo.size(), -1);
+    serves.assign(2 * static_cast<size_t>(length), 0);
+    for (int i = 0; i < length; ++i) {
+        if (tour.isPath(i)) {
+            continue;
+        }
+        edgeOf[i] = tour.edgeOf(i);
+        if (servedAt[edgeOf[i]] < 0) {
+            servedAt[edgeOf[i]] = i;
+            serves[i] = serves[i + length] = 1;
+        }
+    }
+}
+
+/**
+ * @brief Trims the route [begin, end) to its serving steps.
+ *
+ * Positions are taken modulo the walk length; end - begin is at most the length.
+ */
+RouteAnnealer::Span RouteAnnealer::span(int begin, int end) const {
+    while (begin < 0) {
+        begin += length;
+        end += length;
+    }
+    while (begin >= length) {
+        begin -= length;
+        end -= length;
+    }
+    int first = begin;
+    while (first < end && !serves[first]) {
+        ++first;
+    }
+    if (first == end) {
+        return {0, -1, -1};
+    }
+    int last = end - 1;
+    while (!serves[last]) {
+        --last;
+    }
+    return {prefix[last + 1] - prefix[first], first, last};
+}
+
+/**
+ * @brief Returns the route that contains token position (in [0, length)).
+ */
+int RouteAnnealer::routeOf(int position) const {
+    if (position < cut[0]) {
+        position += length;
+    }
+    return static_cast<int>(upper_bound(cut.begin(), cut.end(), position) - cut.begin()) - 1;
+}
+
+/**
+ * @brief Moves the service of the edge at token from to token to.
+ */
+void RouteAnnealer::flipService(int from, int to) {
+    serves[from] = serves[from + length] = 0;
+    serves[to] = serves[to + length] = 1;
+    servedAt[edgeOf[to]] = to;
+}
+
+/**
+ * @brief Anneals the cut points and returns the trimmed routes.
+ *
+ * @param n The number of postmen.
+ * @param budgetMillis Wall-clock limit of the search.
+ * @param seed Seed of the move generator.
+ * @return The token ranges of every postman (tour 0); a route across the end of the walk has two.
+ */
+vector<vector<TokenRange>> RouteAnnealer::balance(int n, int budgetMillis, uint32_t seed) {
+    vector<vector<TokenRange>> routes(n);
+    if (length == 0) {
+        return routes;
+    }
+    cut.resize(n);
+    for (int i = 0; i < n; ++i) {
+        cut[i] = static_cast<int>(static_cast<long long>(length) * i / n);
+    }
+    auto endOf = [&](int i) { return i + 1 < n ? cut[i + 1] : cut[0] + length; };
+
+    vector<long long> cost(n);
+    long long total = 0;
+    for (int i = 0; i < n; ++i) {
+        cost[i] = span(cut[i], endOf(i)).cost;
+        total += cost[i];
+    }
+    long long longest = *max_element(cost.begin(), cost.end());
+    int atLongest = static_cast<int>(count(cost.begin(), cost.end(), longest));
+    const double totalWeight = 0.25 / n;
+
+    // The longest route after routes a and b (possibly equal) take the costs ca and cb.
+    auto longestAfter = [&](int a, long long ca, int b, long long cb) {
+        long long changed = max(ca, cb);
+        if (changed >= longest) {
+            return changed;
+        }
+        int lost = (cost[a] == longest) + (b != a && cost[b] == longest);
+        if (lost < atLongest) {
+            return longest;
+        }
+        long long result = changed;
+        for (int i = 0; i < n; ++i) {
+            if (i != a && i != b) {
+                result = max(result, cost[i]);
+            }
+        }
+        return result;
+    };
+    auto commit = [&](int a, long long ca, int b, long long cb, long long newLongest) {
+        total += ca - cost[a] + (b != a ? cb - cost[b] : 0);
+        atLongest -= (cost[a] == longest) + (b != a && cost[b] == longest);
+        cost[a] = ca;
+        cost[b] = cb;
+        if (newLongest != longest) {
+            longest = newLongest;
+            atLongest = static_cast<int>(count(cost.begin(), cost.end(), longest));
+        } else {
+            atLongest += (ca == longest) + (b != a && cb == longest);
+        }
+    };
+
+    mt19937 rng(seed);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    const long long moves = static_cast<long long>(moveFactor) * length;
+    const int maxShift = max(1, min(16, length / (2 * n)));
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(budgetMillis);
+    double temperature = startTemperature;
+    long long bestLongest = longest;
+    vector<int> bestCut = cut;
+    vector<int> bestServedAt = servedAt;
+
+    for (long long k = 0; k < moves; ++k) {
+        if ((k & 255) == 0) {
+            if (chrono::steady_clock::now() > deadline) {
+                break;
+            }
+            temperature = startTemperature * pow(endTemperature / startTemperature, static_cast<double>(k) / moves);
+        }
+        auto accept = [&](long long newLongest, long long newTotal) {
+            double delta = static_cast<double>(newLongest - longest) + totalWeight * static_cast<double>(newTotal - total);
+            return delta <= 0 || unit(rng) < exp(-delta / temperature);
+        };
+
+        if (rng() & 1) {
+            // Shift the start of route i; route prev ends there.
+            int i = static_cast<int>(rng() % n);
+            int step = 1 + static_cast<int>(rng() % maxShift);
+            int c = cut[i] + ((rng() & 1) ? step : -step);
+            int prev = (i + n - 1) % n;
+            int lower = i > 0 ? cut[i - 1] : cut[n - 1] - length;
+            int upper = endOf(i);
+            if (n > 1 && (c < lower || c > upper)) {
+                continue;
+            }
+            long long ci = span(c, n > 1 ? upper : c + length).cost;
+            long long cp = n > 1 ? span(cut[prev], i > 0 ? c : c + length).cost : ci;
+            long long newLongest = longestAfter(i, ci, prev, cp);
+            if (!accept(newLongest, total + ci - cost[i] + (prev != i ? cp - cost[prev] : 0))) {
+                continue;
+            }
+            cut[i] = c;
+            commit(i, ci, prev, cp, newLongest);
+            if (cut[0] < 0 || cut[0] >= length) {
+                int by = cut[0] < 0 ? length : -length;
+                for (int& start : cut) {
+                    start += by;
+                }
+            }
+        } else {
+            // Serve the edge at token s instead of where it is served now.
+            int s = static_cast<int>(rng() % length);
+            if (serves[s] || edgeOf[s] < 0) {
+                continue;
+            }
+            int t = servedAt[edgeOf[s]];
+            int rs = routeOf(s);
+            int rt = routeOf(t);
+            flipService(t, s);
+            long long cs = span(cut[rs], endOf(rs)).cost;
+            long long ct = rt != rs ? span(cut[rt], endOf(rt)).cost : cs;
+            long long newLongest = longestAfter(rs, cs, rt, ct);
+            if (!accept(newLongest, total + cs - cost[rs] + (rt != rs ? ct - cost[rt] : 0))) {
+                flipService(s, t);
+                continue;
+            }
+            commit(rs, cs, rt, ct, newLongest);
+        }
+        if (longest < bestLongest) {
+            bestLongest = longest;
+            bestCut = cut;
+            bestServedAt = servedAt;
+        }
+    }
+
+    if (longest > bestLongest) {
+        cut = bestCut;
+        servedAt = bestServedAt;
+        fill(serves.begin(), serves.end(), 0);
+        for (int step : servedAt) {
+            if (step >= 0) {
+                serves[step] = serves[step + length] = 1;
+            }
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        Span s = span(cut[i], endOf(i));
+        if (s.first < 0) {
+            continue;
+        }
+        if (s.last < length) {
+            routes[i].push_back({0, s.first, s.last + 1});
+        } else {
+            routes[i].push_back({0, s.first, length});
+            routes[i].push_back({0, 0, s.last + 1 - length});
+        }
+    }
+    return routes;
+}
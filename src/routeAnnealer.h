@@ -0,0 +1,61 @@
+#ifndef ROUTE_ANNEALER_H
+#define ROUTE_ANNEALER_H
+
+#include <cstdint>
+#include <vector>
+#include "compactTour.h"
+
+/**
+ * @file routeAnnealer.h
+ * @brief Simulated annealing of the cut points when a compact closed walk is split between postmen.
+ *
+ * The walk is cut into n consecutive, cyclically ordered routes. Every edge is served by one
+ * of its edge tokens; the others and all path tokens are deadhead. A route only has to run
+ * from its first to its last serving token, so deadhead at either end of a route is dropped.
+ * The cost of a route is then one difference of cached prefix costs after stepping over
+ * those ends; no path is expanded.
+ *
+ * Moves:
+ * - shift the boundary between two neighbouring routes by a few steps (the first boundary
+ *   may move across the start of the walk, which rotates it);
+ * - move the service of a repeated edge to another of its edge tokens, which can turn the
+ *   token at a route end into deadhead.
+ *
+ * A move is scored from the two routes it touches. The annealing minimises the longest route,
+ * then the total cost. The temperature follows the move index, so a run that reaches its move
+ * cap (moveFactor moves per token of the walk) before the time budget is a pure function of
+ * the seed.
+ */
+class RouteAnnealer {
+public:
+    static constexpr int moveFactor = 20;
+    static constexpr double startTemperature = 2.0;
+    static constexpr double endTemperature = 0.02;
+
+    /**
+     * @param tour The closed walk.
+     */
+    explicit RouteAnnealer(const CompactTour& tour);
+
+    std::vector<std::vector<TokenRange>> balance(int n, int budgetMillis, uint32_t seed);
+
+private:
+    struct Span {
+        long long cost;
+        int first;  ///< First serving token, or -1 for a route without any.
+        int last;   ///< Last serving token.
+    };
+
+    Span span(int begin, int end) const;
+    int routeOf(int position) const;
+    void flipService(int from, int to);
+
+    int length;
+    std::vector<long long> prefix;   ///< Cost of tokens [0, i) of the walk taken twice.
+    std::vector<int> edgeOf;         ///< Edge ID of every edge token, -1 for path tokens.
+    std::vector<int> servedAt;       ///< Serving token of every edge.
+    std::vector<char> serves;        ///< Whether token i (of the walk taken twice) serves its edge.
+    std::vector<int> cut;            ///< Start of every route, increasing, cut[0] in [0, length).
+};
+
+#endif // ROUTE_ANNEALER_H
@@ -0,0 +1,560 @@
+#include "shardCoordinator.h"
+#include "binaryFormat.h"
+#include "graph.h"
+#include "trace.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+const uint8_t jobFrame = 'J';
+const uint8_t resultFrame = 'R';
+const uint8_t quitFrame = 'Q';
+const uint8_t helloFrame = 'H';
+const uint32_t maxFrame = 1u << 30;
+
+bool sendAll(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool readAll(int fd, uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = recv(fd, data, size, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool sendFrame(int fd, uint8_t type, const vector<uint8_t>& payload) {
+    uint32_t length = static_cast<uint32_t>(payload.size() + 1);
+    uint8_t header[5];
+    for (int i = 0; i < 4; ++i) {
+        header[i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+    header[4] = type;
+    return sendAll(fd, header, sizeof(header)) && sendAll(fd, payload.data(), payload.size());
+}
+
+/**
+ * @brief Reads one frame; false when the connection ends or the frame is malformed.
+ */
+bool readFrame(int fd, uint8_t& type, vector<uint8_t>& payload) {
+    uint8_t header[5];
+    if (!readAll(fd, header, sizeof(header))) {
+        return false;
+    }
+    uint32_t length = 0;
+    for (int i = 0; i < 4; ++i) {
+        length |= static_cast<uint32_t>(header[i]) << (8 * i);
+    }
+    if (length == 0 || length > maxFrame) {
+        return false;
+    }
+    type = header[4];
+    payload.resize(length - 1);
+    return readAll(fd, payload.data(), payload.size());
+}
+
+/**
+ * @brief Appends to inbox what has arrived on fd, without waiting for more.
+ *
+ * @return false when the connection has ended; inbox still holds what came before that.
+ */
+bool receiveAvailable(int fd, vector<uint8_t>& inbox) {
+    const size_t chunk = 1 << 16;
+    for (;;) {
+        size_t size = inbox.size();
+        inbox.resize(size + chunk);
+        ssize_t got = recv(fd, inbox.data() + size, chunk, MSG_DONTWAIT);
+        inbox.resize(size + static_cast<size_t>(max<ssize_t>(got, 0)));
+        if (got > 0) {
+            continue;
+        }
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        return got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+/**
+ * @brief Takes the first frame off inbox once it has arrived whole.
+ *
+ * @return 1 if a frame was taken, 0 if inbox holds only part of one, -1 if it is malformed.
+ */
+int takeFrame(vector<uint8_t>& inbox, uint8_t& type, vector<uint8_t>& payload) {
+    if (inbox.size() < 5) {
+        return 0;
+    }
+    uint32_t length = 0;
+    for (int i = 0; i < 4; ++i) {
+        length |= static_cast<uint32_t>(inbox[i]) << (8 * i);
+    }
+    if (length == 0 || length > maxFrame) {
+        return -1;
+    }
+    if (inbox.size() < 4 + static_cast<size_t>(length)) {
+        return 0;
+    }
+    type = inbox[4];
+    payload.assign(inbox.begin() + 5, inbox.begin() + 4 + length);
+    inbox.erase(inbox.begin(), inbox.begin() + 4 + length);
+    return 1;
+}
+
+void appendVarint(vector<uint8_t>& out, uint64_t value) {
+    uint8_t bytes[10];
+    size_t n = encodeVarint(value, bytes);
+    out.insert(out.end(), bytes, bytes + n);
+}
+
+/**
+ * @brief Whether steps is one continuous walk over the edges of a shard that serves every one of them.
+ *
+ * @param edges The shard's edges as (smaller, larger) endpoint pairs, sorted and unique.
+ */
+bool servesShard(const vector<pair<int, int>>& edges, const vector<pair<int, int>>& steps) {
+    vector<char> served(edges.size(), 0);
+    size_t left = edges.size();
+    for (size_t k = 0; k < steps.size(); ++k) {
+        if (k > 0 && steps[k].first != steps[k - 1].second) {
+            return false;
+        }
+        pair<int, int> edge = minmax(steps[k].first, steps[k].second);
+        auto it = lower_bound(edges.begin(), edges.end(), edge);
+        if (it == edges.end() || *it != edge) {
+            return false;
+        }
+        size_t id = static_cast<size_t>(it - edges.begin());
+        left -= served[id] == 0;
+        served[id] = 1;
+    }
+    return left == 0;
+}
+
+}  // namespace
+
+/**
+ * @brief Opens the port workers connect to.
+ *
+ * @throws std::runtime_error If the address is invalid or the port cannot be opened.
+ */
+ShardCoordinator::ShardCoordinator(const string& listenAddress, int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, listenAddress.c_str(), &address.sin_addr) != 1) {
+        throw runtime_error("Invalid address to listen for shard workers on: " + listenAddress);
+    }
+    listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        throw runtime_error("Could not open a socket for the shard workers.");
+    }
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    socklen_t size = sizeof(address);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), size) != 0 || listen(listener, 64) != 0 ||
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &size) != 0) {
+        close(listener);
+        throw runtime_error("Could not listen for shard workers on " + listenAddress + ":" + to_string(port) + ".");
+    }
+    this->port = ntohs(address.sin_port);
+    host = address.sin_addr.s_addr == htonl(INADDR_ANY) ? "127.0.0.1" : listenAddress;
+    inet_pton(AF_INET, host.c_str(), &hostAddress);
+}
+
+/**
+ * @brief Tells the connected workers to quit and stops the local ones.
+ */
+ShardCoordinator::~ShardCoordinator() {
+    for (const Worker& worker : workers) {
+        sendFrame(worker.fd, quitFrame, {});
+        close(worker.fd);
+    }
+    close(listener);
+    for (pid_t child : children) {
+        kill(child, SIGTERM);
+        waitpid(child, nullptr, 0);
+    }
+}
+
+/**
+ * @brief Starts a local worker: this program with --worker, connected to the listening port.
+ */
+void ShardCoordinator::launchWorker() {
+    string program = "main";
+    string flag = "--worker";
+    string address = host + ":" + to_string(port);
+    char* argv[] = {&program[0], &flag[0], &address[0], nullptr};
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw runtime_error("Could not start a shard worker.");
+    }
+    if (pid == 0) {
+        execv("/proc/self/exe", argv);
+        _exit(127);
+    }
+    children.push_back(pid);
+}
+
+/**
+ * @brief Forgets the local workers that have exited.
+ */
+void ShardCoordinator::reapWorkers() {
+    for (size_t i = children.size(); i-- > 0;) {
+        if (waitpid(children[i], nullptr, WNOHANG) == children[i]) {
+            children.erase(children.begin() + static_cast<long>(i));
+        }
+    }
+}
+
+/**
+ * @brief Closes the connection of worker i and queues its shard again.
+ *
+ * @param reason What went wrong, for the message ("disconnected", ...).
+ * @throws std::runtime_error If the shard has failed maxAttempts times.
+ */
+void ShardCoordinator::dropWorker(size_t i, const char* reason, deque<int>& pending, vector<int>& attempts) {
+    int shard = workers[i].shard;
+    close(workers[i].fd);
+    workers.erase(workers.begin() + static_cast<long>(i));
+    if (shard < 0) {
+        return;
+    }
+    if (++attempts[shard] >= maxAttempts) {
+        throw runtime_error("Shard " + to_string(shard) + " failed in " + to_string(maxAttempts) + " workers.");
+    }
+    cerr << "The worker of shard " << shard << " " << reason << ", solving it again (attempt " << attempts[shard] + 1 << ")." << endl;
+    pending.push_front(shard);
+}
+
+/**
+ * @brief Solves every shard in a worker process.
+ *
+ * Up to localWorkers local workers run while shards are left; one that exits is replaced
+ * as long as shards are waiting. Workers on other hosts may join at any time.
+ *
+ * @param shards The shards; empty ones are not sent.
+ * @param localWorkers The number of local workers to keep running.
+ * @param options Options of the whole run (the workers use annealMillis).
+ * @param seed Seed of the whole run.
+ * @return The walk of every shard, in shard vertices.
+ *
+ * @throws std::runtime_error If a shard fails maxAttempts times or no local worker can be kept running.
+ */
+vector<vector<pair<int, int>>> ShardCoordinator::solve(const vector<GraphShard>& shards, int localWorkers,
+                                                       const SolverOptions& options, int seed) {
+    int n = static_cast<int>(shards.size());
+    vector<vector<uint8_t>> graphs(n);
+    vector<vector<pair<int, int>>> sortedEdges(n);
+    deque<int> pending;
+    for (int p = 0; p < n; ++p) {
+        if (!shards[p].edges.empty()) {
+            graphs[p] = encodeBinaryGraph(static_cast<int>(shards[p].globalIds.size()), shards[p].edges);
+            pending.push_back(p);
+            for (const auto& [u, v] : shards[p].edges) {
+                sortedEdges[p].push_back(minmax(u, v));
+            }
+            sort(sortedEdges[p].begin(), sortedEdges[p].end());
+            sortedEdges[p].erase(unique(sortedEdges[p].begin(), sortedEdges[p].end()), sortedEdges[p].end());
+        }
+    }
+    vector<vector<pair<int, int>>> results(n);
+    vector<int> attempts(n, 0);
+    int remaining = static_cast<int>(pending.size());
+    int launches = 0;
+    const int maxLaunches = localWorkers + maxAttempts * n;
+
+    auto acceptResult = [&](Worker& worker, const vector<uint8_t>& payload) {
+        try {
+            ByteReader in(payload.data(), payload.size());
+            if (static_cast<int64_t>(in.varint()) != worker.shard) {
+                return false;
+            }
+            const GraphShard& shard = shards[worker.shard];
+            uint64_t count = in.varint();
+            vector<pair<int, int>> steps;
+            steps.reserve(min<uint64_t>(count, payload.size()));
+            for (uint64_t k = 0; k < count; ++k) {
+                uint64_t u = in.varint();
+                uint64_t v = in.varint();
+                if (u >= shard.globalIds.size() || v >= shard.globalIds.size()) {
+                    return false;
+                }
+                steps.emplace_back(static_cast<int>(u), static_cast<int>(v));
+            }
+            if (!servesShard(sortedEdges[worker.shard], steps)) {
+                return false;
+            }
+            results[worker.shard] = move(steps);
+        } catch (const runtime_error&) {
+            return false;
+        }
+        worker.shard = -1;
+        --remaining;
+        return true;
+    };
+
+    while (remaining > 0) {
+        // A worker past its deadline is dropped; a local one is killed too, so that a
+        // replacement can take its place.
+        auto now = chrono::steady_clock::now();
+        for (size_t i = workers.size(); i-- > 0;) {
+            if (workers[i].shard < 0 || now < workers[i].deadline) {
+                continue;
+            }
+            if (find(children.begin(), children.end(), workers[i].pid) != children.end()) {
+                kill(workers[i].pid, SIGKILL);
+            }
+            dropWorker(i, "did not answer in time", pending, attempts);
+        }
+        reapWorkers();
+        while (!pending.empty() && static_cast<int>(children.size()) < min(localWorkers, remaining)) {
+            if (launches++ == maxLaunches) {
+                throw runtime_error("Could not keep the shard workers running.");
+            }
+            launchWorker();
+        }
+
+        for (size_t i = 0; i < workers.size() && !pending.empty();) {
+            if (workers[i].shard >= 0) {
+                ++i;
+                continue;
+            }
+            int p = pending.front();
+            pending.pop_front();
+            workers[i].shard = p;
+            workers[i].deadline = chrono::steady_clock::now() + chrono::seconds(options.workerTimeout);
+            vector<uint8_t> job;
+            appendVarint(job, static_cast<uint64_t>(p));
+            appendVarint(job, static_cast<uint64_t>(attempts[p]));
+            appendVarint(job, zigzagEncode(seed));
+            appendVarint(job, static_cast<uint64_t>(options.annealMillis));
+            job.insert(job.end(), graphs[p].begin(), graphs[p].end());
+            if (sendFrame(workers[i].fd, jobFrame, job)) {
+                ++i;
+            } else {
+                dropWorker(i, "disconnected", pending, attempts);
+            }
+        }
+
+        vector<pollfd> fds;
+        fds.push_back({listener, POLLIN, 0});
+        for (const Worker& worker : workers) {
+            fds.push_back({worker.fd, POLLIN, 0});
+        }
+        int ready = poll(fds.data(), fds.size(), pollMillis);
+        if (ready < 0 && errno != EINTR) {
+            throw runtime_error("Waiting for the shard workers failed.");
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        for (size_t i = workers.size(); i-- > 0;) {
+            if (fds[i + 1].revents == 0) {
+                continue;
+            }
+            bool open = receiveAvailable(workers[i].fd, workers[i].inbox);
+            const char* failure = nullptr;
+            uint8_t type = 0;
+            vector<uint8_t> payload;
+            int taken = 0;
+            while (failure == nullptr && (taken = takeFrame(workers[i].inbox, type, payload)) > 0) {
+                if (type == helloFrame) {
+                    try {
+                        ByteReader in(payload.data(), payload.size());
+                        workers[i].pid = workers[i].local ? static_cast<pid_t>(in.varint()) : 0;
+                    } catch (const runtime_error&) {
+                        failure = "sent an invalid hello";
+                    }
+                } else if (type != resultFrame || workers[i].shard < 0 || !acceptResult(workers[i], payload)) {
+                    failure = "sent an invalid result";
+                }
+            }
+            if (failure == nullptr && taken < 0) {
+                failure = "sent an invalid frame";
+            }
+            if (failure == nullptr && !open) {
+                failure = "disconnected";
+            }
+            if (failure != nullptr) {
+                dropWorker(i, failure, pending, attempts);
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            sockaddr_in peer{};
+            socklen_t size = sizeof(peer);
+            int fd = accept4(listener, reinterpret_cast<sockaddr*>(&peer), &size, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                int yes = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                timeval sendTimeout{options.workerTimeout, 0};
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+                workers.push_back({fd, peer.sin_addr.s_addr == hostAddress});
+            }
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief Solves the k-postman problem on a connected graph with the shards of shardGraph
+ *        solved in worker processes (--workers).
+ *
+ * Components solved at the same time take turns, as their coordinators share the port.
+ *
+ * @param n The number of postmen (parts).
+ * @return One closed walk and route per part.
+ */
+CompactRoutes Graph::solveSharded(int n) {
+    static mutex coordinatorMutex;
+    vector<GraphShard> shards = shardGraph(n);
+    vector<vector<pair<int, int>>> steps;
+    {
+        lock_guard<mutex> lock(coordinatorMutex);
+        TraceScope trace("shard workers", options.workers);
+        ShardCoordinator coordinator(options.listenAddress, options.port);
+        steps = coordinator.solve(shards, options.workers, options, seed);
+    }
+
+    CompactRoutes result;
+    result.routes.resize(n);
+    for (int p = 0; p < n; ++p) {
+        addShardRoute(result, p, shards[p].globalIds, steps[p]);
+    }
+    return result;
+}
+
+/**
+ * @brief Runs a worker (--worker host:port): solves the shards the coordinator sends until it quits.
+ *
+ * @param address The coordinator as host:port.
+ * @return 0 once told to quit, 1 if the coordinator cannot be reached or goes away.
+ */
+int runShardWorker(const string& address) {
+    size_t colon = address.rfind(':');
+    if (colon == string::npos) {
+        cerr << "Invalid coordinator address: " << address << endl;
+        return 1;
+    }
+    string host = address.substr(0, colon);
+    string service = address.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &found) != 0) {
+        cerr << "Unknown coordinator address: " << address << endl;
+        return 1;
+    }
+    int fd = -1;
+    for (int attempt = 0; attempt < 50 && fd < 0; ++attempt) {
+        for (addrinfo* a = found; a != nullptr && fd < 0; a = a->ai_next) {
+            fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+            if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (fd < 0) {
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+    }
+    freeaddrinfo(found);
+    if (fd < 0) {
+        cerr << "Could not connect to the coordinator at " << address << endl;
+        return 1;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    vector<uint8_t> hello;
+    appendVarint(hello, static_cast<uint64_t>(getpid()));
+    if (!sendFrame(fd, helloFrame, hello)) {
+        close(fd);
+        return 1;
+    }
+
+    const char* crash = getenv("CPP_WORKER_CRASH");
+    const char* hang = getenv("CPP_WORKER_HANG");
+    uint8_t type = 0;
+    vector<uint8_t> payload;
+    while (readFrame(fd, type, payload)) {
+        if (type == quitFrame) {
+            close(fd);
+            return 0;
+        }
+        if (type != jobFrame) {
+            break;
+        }
+        ByteReader in(payload.data(), payload.size());
+        uint64_t shard = in.varint();
+        uint64_t attempt = in.varint();
+        int seed = static_cast<int>(in.zigzag());
+        SolverOptions options;
+        options.quiet = true;
+        options.annealMillis = static_cast<int>(in.varint());
+        if (crash != nullptr && attempt == 0 && strtoull(crash, nullptr, 10) == shard) {
+            abort();
+        }
+        if (hang != nullptr && attempt == 0 && strtoull(hang, nullptr, 10) == shard) {
+            for (;;) {
+                pause();
+            }
+        }
+        int vertices = 0;
+        vector<pair<int, int>> edges;
+        size_t start = in.position();
+        decodeBinaryGraph(payload.data() + start, payload.size() - start, "shard " + to_string(shard), vertices, edges);
+
+        vector<pair<int, int>> steps = solveShard(vertices, edges, options, seed);
+        vector<uint8_t> result;
+        result.reserve(4 * steps.size() + 16);
+        appendVarint(result, shard);
+        appendVarint(result, steps.size());
+        for (const auto& [u, v] : steps) {
+            appendVarint(result, static_cast<uint64_t>(u));
+            appendVarint(result, static_cast<uint64_t>(v));
+        }
+        if (!sendFrame(fd, resultFrame, result)) {
+            break;
+        }
+    }
+    close(fd);
+    return 1;
+}
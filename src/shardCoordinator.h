@@ -0,0 +1,93 @@
+#ifndef SHARD_COORDINATOR_H
+#define SHARD_COORDINATOR_H
+
+#include <sys/types.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graphPartition.h"
+#include "options.h"
+
+/**
+ * @file shardCoordinator.h
+ * @brief Solving the shards of a partitioned graph in worker processes (--workers).
+ *
+ * The coordinator listens on a TCP port, of the loopback interface unless --listen says
+ * otherwise, and starts local workers as "main --worker host:port"; workers on other
+ * hosts can be started by hand with the same flag and join while shards are left. The
+ * connection is not authenticated, so only listen on networks whose hosts are trusted.
+ *
+ * Every idle worker is sent the next shard as a job, and answers with the walk of that
+ * shard. A worker that disconnects or dies while it holds a shard, answers with anything
+ * but one continuous walk over the shard's edges that serves all of them, or does not
+ * answer within --worker-timeout seconds, loses it: the shard goes back to the queue and
+ * a replacement local worker is started. A shard is given up on, and the solve fails,
+ * after maxAttempts attempts.
+ *
+ * Messages are frames on the connection:
+ * @code
+ * frame:   u32le:length u8:type payload        (length counts the type and the payload)
+ * 'J' job:     varint:shard varint:attempt zigzag:seed varint:annealMillis graph
+ *              (graph is the shard in the binary graph format, to the end of the frame)
+ * 'R' result:  varint:shard varint:steps (varint:u varint:v)*   (shard vertices)
+ * 'H' hello:   varint:pid       (sent once by a worker after connecting)
+ * 'Q' quit
+ * @endcode
+ *
+ * The coordinator never waits on one worker: it reads whatever has arrived and keeps a
+ * partial frame until the rest comes, so a worker that stalls in the middle of a frame is
+ * still dropped at its deadline. A send that a worker does not take within --worker-timeout
+ * seconds drops it as well. A local worker that misses its deadline is killed, which the
+ * hello's process ID allows.
+ * For testing, a worker started with the environment variable CPP_WORKER_CRASH=s aborts
+ * when it receives the first attempt of shard s, and one started with CPP_WORKER_HANG=s
+ * never answers it.
+ */
+class ShardCoordinator {
+public:
+    static constexpr int maxAttempts = 3;
+    static constexpr int pollMillis = 200;
+
+    /**
+     * @param address The IPv4 address to accept workers on, "127.0.0.1" for this host only.
+     * @param port The port to accept workers on, 0 for any free port.
+     */
+    ShardCoordinator(const std::string& address, int port);
+    ~ShardCoordinator();
+
+    ShardCoordinator(const ShardCoordinator&) = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+    int getPort() const { return port; }
+
+    std::vector<std::vector<std::pair<int, int>>> solve(const std::vector<GraphShard>& shards, int localWorkers,
+                                                        const SolverOptions& options, int seed);
+
+private:
+    struct Worker {
+        int fd;
+        bool local;      ///< Connected from the address local workers use.
+        int shard = -1;  ///< Shard being solved, -1 when idle.
+        pid_t pid = 0;   ///< Process ID from the hello of a local worker, 0 before it.
+        std::chrono::steady_clock::time_point deadline{};  ///< When the shard must be solved by.
+        std::vector<uint8_t> inbox;  ///< Bytes received that do not make a whole frame yet.
+    };
+
+    void launchWorker();
+    void reapWorkers();
+    void dropWorker(size_t i, const char* reason, std::deque<int>& pending, std::vector<int>& attempts);
+
+    int listener = -1;
+    int port = 0;
+    std::string host;          ///< Address local workers connect to.
+    uint32_t hostAddress = 0;  ///< host in network byte order.
+    std::vector<Worker> workers;
+    std::vector<pid_t> children;  ///< Local workers not reaped yet.
+};
+
+int runShardWorker(const std::string& address);
+
+#endif // SHARD_COORDINATOR_H
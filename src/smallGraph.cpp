@@ -0,0 +1,48 @@
+#include "smallGraph.h"
+
+using namespace std;
+
+/**
+ * @brief Copies the graph into the smallest fitting SmallGraph and builds its closed walk.
+ */
+template <int N>
+static bool closedWalkWith(const AdjacencyIndex& adjacency, int vertices, vector<int>& matching,
+                           vector<pair<int, int>>& walk) {
+    SmallGraph<N> graph(vertices);
+    for (int u = 0; u < vertices; ++u) {
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (u < v) {
+                graph.addEdge(u, v);
+            }
+        });
+    }
+    return graph.closedWalk(matching, walk);
+}
+
+/**
+ * @brief Builds a closed walk over every edge of a graph with at most 64 vertices.
+ *
+ * Picks SmallGraph<16>, <32> or <64> from the vertex count, so small zones keep their
+ * working arrays small. The walk has minimum length when the graph has at most
+ * SmallGraph::maxExactOdd odd vertices; above that the odd vertices are paired greedily
+ * and the walk may be longer.
+ *
+ * @param adjacency The edges of the graph.
+ * @param vertices The number of vertices.
+ * @param matching DP buffer, reused between calls.
+ * @param walk Receives the walk as (from, to) steps.
+ * @return false if the graph has more than 64 vertices or its edges are not connected.
+ */
+bool smallClosedWalk(const AdjacencyIndex& adjacency, int vertices, vector<int>& matching,
+                     vector<pair<int, int>>& walk) {
+    if (vertices <= 16) {
+        return closedWalkWith<16>(adjacency, vertices, matching, walk);
+    }
+    if (vertices <= 32) {
+        return closedWalkWith<32>(adjacency, vertices, matching, walk);
+    }
+    if (vertices <= 64) {
+        return closedWalkWith<64>(adjacency, vertices, matching, walk);
+    }
+    return false;
+}
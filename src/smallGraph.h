@@ -0,0 +1,267 @@
+#ifndef SMALL_GRAPH_H
+#define SMALL_GRAPH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "adjacency.h"
+
+/**
+ * @file smallGraph.h
+ * @brief Chinese postman tour of graphs with at most 64 vertices held in registers.
+ *
+ * Every adjacency row is one 64-bit word, so degrees and parity are popcounts, a BFS level
+ * is an OR over the rows of the previous level, and all working state lives in fixed-size
+ * arrays on the stack. Up to maxExactOdd odd vertices are paired optimally with a bitmask
+ * DP over their shortest path distances (all edges weigh 1, so BFS gives the distances);
+ * larger odd sets are paired greedily.
+ */
+template <int N>
+class SmallGraph {
+    static_assert(N > 0 && N <= 64, "SmallGraph rows are single 64-bit words");
+
+public:
+    static constexpr int maxExactOdd = 14;  ///< Largest odd vertex count matched by the exact DP (2^14 states, ~0.1 ms).
+
+    explicit SmallGraph(int vertices) : vertices(vertices) {}
+
+    void addEdge(int u, int v) {
+        rows[u] |= bit(v);
+        rows[v] |= bit(u);
+    }
+
+    int degree(int u) const { return __builtin_popcountll(rows[u]); }
+
+    uint64_t oddVertices() const {
+        uint64_t odd = 0;
+        for (int u = 0; u < vertices; ++u) {
+            odd |= static_cast<uint64_t>(degree(u) & 1) << u;
+        }
+        return odd;
+    }
+
+    /**
+     * @brief Breadth-first search from source; levels[d] receives the vertices at distance d.
+     *
+     * @return The number of levels.
+     */
+    int bfs(int source, uint64_t (&levels)[N]) const {
+        uint64_t seen = bit(source);
+        levels[0] = seen;
+        int count = 1;
+        while (count < N) {
+            uint64_t frontier = 0;
+            for (uint64_t rest = levels[count - 1]; rest; rest &= rest - 1) {
+                frontier |= rows[__builtin_ctzll(rest)];
+            }
+            frontier &= ~seen;
+            if (!frontier) {
+                break;
+            }
+            seen |= frontier;
+            levels[count++] = frontier;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Builds a closed walk over every edge, repeating as few edges as it can.
+     *
+     * Odd vertices are paired along shortest paths: exactly by a bitmask DP when there are at
+     * most maxExactOdd of them, otherwise greedily closest pair first. The paths are added as
+     * edge copies and a Hierholzer walk is taken from the first vertex with an edge,
+     * preferring unused original edges over copies.
+     *
+     * @param matching DP buffer, reused between calls.
+     * @param walk Receives the walk as (from, to) steps.
+     * @return false if the edges are not connected.
+     */
+    bool closedWalk(std::vector<int>& matching, std::vector<std::pair<int, int>>& walk) const {
+        walk.clear();
+        uint64_t odd = oddVertices();
+        int k = __builtin_popcountll(odd);
+        int oddList[N];
+        uint8_t distance[N][N];
+        uint64_t levels[N];
+        for (int i = 0; i < k; ++i) {
+            oddList[i] = __builtin_ctzll(odd);
+            odd &= odd - 1;
+        }
+        for (int i = 0; i < k; ++i) {
+            int count = bfs(oddList[i], levels);
+            uint64_t reached = 0;
+            for (int d = 0; d < count; ++d) {
+                reached |= levels[d];
+                for (int j = 0; j < k; ++j) {
+                    if (levels[d] & bit(oddList[j])) {
+                        distance[i][j] = static_cast<uint8_t>(d);
+                    }
+                }
+            }
+            for (int j = 0; j < k; ++j) {
+                if (!(reached & bit(oddList[j]))) {
+                    return false;
+                }
+            }
+        }
+
+        int pairs[N][2];
+        int pairCount = k <= maxExactOdd ? matchExactly(k, distance, matching, pairs) : matchGreedily(k, distance, pairs);
+        uint8_t extra[N][N] = {};
+        uint64_t extraRows[N] = {};
+        size_t steps = 0;
+        for (int u = 0; u < vertices; ++u) {
+            steps += degree(u);
+        }
+        steps /= 2;
+        for (int p = 0; p < pairCount; ++p) {
+            addPathCopies(oddList[pairs[p][0]], oddList[pairs[p][1]], levels, extra, extraRows);
+            steps += distance[pairs[p][0]][pairs[p][1]];
+        }
+
+        int start = -1;
+        for (int u = 0; u < vertices && start == -1; ++u) {
+            if (rows[u]) {
+                start = u;
+            }
+        }
+        if (start == -1) {
+            return true;
+        }
+        uint64_t unused[N];
+        std::copy(rows, rows + N, unused);
+        int stack[N * (N - 1) / 2 + N / 2 * N + 1];
+        int top = 0;
+        stack[top++] = start;
+        while (top > 0) {
+            int u = stack[top - 1];
+            if (unused[u]) {
+                int v = __builtin_ctzll(unused[u]);
+                unused[u] &= ~bit(v);
+                unused[v] &= ~bit(u);
+                stack[top++] = v;
+            } else if (extraRows[u]) {
+                int v = __builtin_ctzll(extraRows[u]);
+                if (--extra[u][v] == 0) {
+                    extraRows[u] &= ~bit(v);
+                }
+                if (--extra[v][u] == 0) {
+                    extraRows[v] &= ~bit(u);
+                }
+                stack[top++] = v;
+            } else {
+                --top;
+                if (top > 0) {
+                    walk.emplace_back(stack[top - 1], u);
+                }
+            }
+        }
+        std::reverse(walk.begin(), walk.end());
+        return walk.size() == steps;
+    }
+
+private:
+    static uint64_t bit(int v) { return uint64_t{1} << v; }
+
+    /**
+     * @brief Minimum-weight perfect matching of k points by DP over the subsets of matched points.
+     *
+     * @return The number of pairs written to pairs.
+     */
+    static int matchExactly(int k, const uint8_t (&distance)[N][N], std::vector<int>& matching, int (&pairs)[N][2]) {
+        if (k == 0) {
+            return 0;
+        }
+        const int unmatched = std::numeric_limits<int>::max();
+        int full = (1 << k) - 1;
+        matching.assign(static_cast<size_t>(full) + 1, unmatched);
+        matching[0] = 0;
+        for (int mask = 1; mask <= full; ++mask) {
+            if (__builtin_popcount(mask) & 1) {
+                continue;
+            }
+            int i = __builtin_ctz(mask);
+            for (int rest = mask & (mask - 1); rest; rest &= rest - 1) {
+                int j = __builtin_ctz(rest);
+                int before = matching[mask & ~(1 << i) & ~(1 << j)];
+                if (before != unmatched && before + distance[i][j] < matching[mask]) {
+                    matching[mask] = before + distance[i][j];
+                }
+            }
+        }
+        int count = 0;
+        for (int mask = full; mask;) {
+            int i = __builtin_ctz(mask);
+            for (int rest = mask & (mask - 1); rest; rest &= rest - 1) {
+                int j = __builtin_ctz(rest);
+                int smaller = mask & ~(1 << i) & ~(1 << j);
+                if (matching[smaller] != unmatched && matching[smaller] + distance[i][j] == matching[mask]) {
+                    pairs[count][0] = i;
+                    pairs[count][1] = j;
+                    count++;
+                    mask = smaller;
+                    break;
+                }
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Pairs k points by repeatedly taking the closest two unpaired ones.
+     *
+     * @return The number of pairs written to pairs.
+     */
+    static int matchGreedily(int k, const uint8_t (&distance)[N][N], int (&pairs)[N][2]) {
+        uint64_t open = k == 64 ? ~uint64_t{0} : bit(k) - 1;
+        int count = 0;
+        while (open) {
+            int bestI = -1, bestJ = -1, best = std::numeric_limits<int>::max();
+            for (uint64_t a = open; a; a &= a - 1) {
+                int i = __builtin_ctzll(a);
+                for (uint64_t b = a & (a - 1); b; b &= b - 1) {
+                    int j = __builtin_ctzll(b);
+                    if (distance[i][j] < best) {
+                        best = distance[i][j];
+                        bestI = i;
+                        bestJ = j;
+                    }
+                }
+            }
+            pairs[count][0] = bestI;
+            pairs[count][1] = bestJ;
+            count++;
+            open &= ~bit(bestI) & ~bit(bestJ);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Adds a copy of every edge on a shortest s-t path, stepping back from t to the lowest neighbour one level closer.
+     */
+    void addPathCopies(int s, int t, uint64_t (&levels)[N], uint8_t (&extra)[N][N], uint64_t (&extraRows)[N]) const {
+        bfs(s, levels);
+        int d = 0;
+        while (!(levels[d] & bit(t))) {
+            ++d;
+        }
+        for (int v = t; d > 0; --d) {
+            int u = __builtin_ctzll(rows[v] & levels[d - 1]);
+            extra[u][v]++;
+            extra[v][u]++;
+            extraRows[u] |= bit(v);
+            extraRows[v] |= bit(u);
+            v = u;
+        }
+    }
+
+    int vertices;
+    uint64_t rows[N] = {};
+};
+
+bool smallClosedWalk(const AdjacencyIndex& adjacency, int vertices, std::vector<int>& matching,
+                     std::vector<std::pair<int, int>>& walk);
+
+#endif // SMALL_GRAPH_H
@@ -3,7 +3,11 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <algorithm>
 #include <nlohmann/json.hpp>
+#include "graph.h"
+#include "binaryFormat.h"
+#include "dotExport.h"
 
 using json = nlohmann::json;
 std::string getColor(int index) {
@@ -14,38 +18,63 @@ std::string getColor(int index) {
 }
 
 int graphViz() {
-    std::string inputFileName = "results.json";
-    std::string outputFileName = "output.dot";
+    return graphViz("results.json", "output.dot");
+}
 
-    std::ifstream inputFile(inputFileName);
-    if (!inputFile.is_open()) {
-        std::cerr << "Error opening input file!" << std::endl;
+/**
+ * @brief Writes a DOT file with every postman's route in its own color.
+ *
+ * The input may be a results.json file or a compact route container (.cpr);
+ * the format is detected from the file's first bytes.
+ *
+ * @param inputFileName The results file to read.
+ * @param outputFileName The DOT file to write.
+ * @return 0 on success, 1 on error.
+ */
+int graphViz(const std::string& inputFileName, const std::string& outputFileName) {
+    std::vector<std::vector<std::pair<int, int>>> routes;
+    int vertices = 0;
+    try {
+        if (isCompactRoutes(inputFileName)) {
+            CompactSolution solution = readCompactRoutes(inputFileName);
+            for (const auto& postman : solution.postmen) {
+                auto& route = routes.emplace_back();
+                for (const auto& walk : postman.walks) {
+                    for (size_t j = 0; j + 1 < walk.size(); ++j) {
+                        route.emplace_back(walk[j], walk[j + 1]);
+                    }
+                }
+            }
+        } else {
+            std::ifstream inputFile(inputFileName);
+            if (!inputFile.is_open()) {
+                std::cerr << "Error opening input file!" << std::endl;
+                return 1;
+            }
+            json inputData;
+            inputFile >> inputData;
+            for (const auto& postman : inputData["postmen"]) {
+                auto& route = routes.emplace_back();
+                for (const auto& edge : postman["routes"]) {
+                    route.emplace_back(edge[0].get<int>(), edge[1].get<int>());
+                }
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
         return 1;
     }
+    for (const auto& route : routes) {
+        for (const auto& edge : route) {
+            vertices = std::max({vertices, edge.first + 1, edge.second + 1});
+        }
+    }
 
-    json inputData;
-    inputFile >> inputData;
-    inputFile.close();
-
-    std::ofstream outputFile(outputFileName);
-    if (!outputFile.is_open()) {
+    SolverOptions defaults;
+    if (!writeDot(outputFileName, vertices, routes, defaults.dotMaxEdges, defaults.dotDetail)) {
         std::cerr << "Error opening output file!" << std::endl;
         return 1;
     }
-    outputFile << "graph G {\n";
-
-    const auto& postmen = inputData["postmen"];
-    for (size_t i = 0; i < postmen.size(); ++i) {
-        std::string color = getColor(i);
-        const auto& routes = postmen[i]["routes"];
-        for (const auto& route : routes) {
-            outputFile << "  " << route[0] << " -- " << route[1]
-                       << " [color=\"" << color << "\"];\n";
-        }
-    }
-
-    outputFile << "}\n";
-    outputFile.close();
 
     std::cout << "DOT file has been created: " << outputFileName << std::endl;
 
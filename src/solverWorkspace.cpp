@@ -0,0 +1,110 @@
+#include "solverWorkspace.h"
+#include "denseDijkstra.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using namespace std;
+
+/**
+ * @file solverWorkspace.cpp
+ * @brief Clears every buffer while keeping its capacity.
+ */
+void SolverWorkspace::reset() {
+    dist.clear();
+    parent.clear();
+    key.clear();
+    heap.clear();
+    edges.clear();
+    matching.clear();
+    added.clear();
+    duplicated.clear();
+    walk.clear();
+}
+
+/**
+ * @brief Returns the number of bytes reserved by the buffers.
+ */
+size_t SolverWorkspace::capacityBytes() const {
+    auto bytes = [](const auto& buffer) { return buffer.capacity() * sizeof(buffer[0]); };
+    return bytes(dist) + bytes(parent) + bytes(key) + bytes(heap) + bytes(edges) + bytes(matching) + bytes(added) + bytes(duplicated) + bytes(walk) +
+           bytes(euler.offset) + bytes(euler.slots) + bytes(euler.fill) + bytes(euler.cursor) + bytes(euler.used) +
+           bytes(euler.stack);
+}
+
+/**
+ * @brief Returns the calling thread's workspace.
+ *
+ * Thread pool workers keep theirs between tasks, so components solved one after another
+ * on the same worker share the buffers.
+ */
+SolverWorkspace& SolverWorkspace::forThisThread() {
+    thread_local SolverWorkspace workspace;
+    return workspace;
+}
+
+/**
+ * @brief Dijkstra's algorithm from start into the workspace's dist and parent buffers.
+ *
+ * Works like dijkstra3, but stops as soon as target is settled (pass -1 for the whole
+ * tree). The parent chain of target is final at that point, so the path is the same.
+ * Dense graphs (see preferDenseDijkstra) use the heap-free denseShortestPathTree; sparse
+ * ones take the neighbours from the adjacency index instead of scanning matrix rows.
+ * Both visit neighbours in increasing order and give the same tree.
+ *
+ * @param start The starting vertex.
+ * @param target The vertex whose path is needed, or -1.
+ * @param adjMatrix The adjacency matrix; adjMatrix[u][v] is the weight of (u, v), 0 if absent.
+ * @param adjacency The adjacency index of the same graph.
+ * @param vertices The number of vertices.
+ * @param workspace Receives the shortest path tree in workspace.parent.
+ */
+void shortestPathTree(int start, int target, const vector<vector<int>>& adjMatrix, const AdjacencyIndex& adjacency,
+                      int vertices, SolverWorkspace& workspace) {
+    if (preferDenseDijkstra(vertices, adjacency.edgeCount())) {
+        denseShortestPathTree(start, target, adjMatrix, vertices, workspace.dist, workspace.key, workspace.parent);
+        return;
+    }
+    vector<int>& dist = workspace.dist;
+    vector<int>& parent = workspace.parent;
+    vector<pair<int, int>>& heap = workspace.heap;
+    dist.assign(vertices, numeric_limits<int>::max());
+    parent.assign(vertices, -1);
+    heap.clear();
+
+    dist[start] = 0;
+    heap.emplace_back(0, start);
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), greater<>());
+        auto [cost, u] = heap.back();
+        heap.pop_back();
+
+        if (cost > dist[u]) continue;
+        if (u == target) break;
+
+        const vector<int>& row = adjMatrix[u];
+        adjacency.forEachNeighbour(u, [&](int v) {
+            if (row[v] > 0 && dist[u] + row[v] < dist[v]) {
+                dist[v] = dist[u] + row[v];
+                parent[v] = u;
+                heap.emplace_back(dist[v], v);
+                push_heap(heap.begin(), heap.end(), greater<>());
+            }
+        });
+    }
+}
+
+/**
+ * @brief Appends the path from start to end in a shortest path tree to out.
+ *
+ * Appends the same (parent, vertex) steps as reconstructPath returns, without a temporary.
+ */
+void appendPath(int start, int end, const vector<int>& parent, vector<pair<int, int>>& out) {
+    size_t first = out.size();
+    int current = end;
+    while (current != -1 && current != start) {
+        out.emplace_back(parent[current], current);
+        current = parent[current];
+    }
+    reverse(out.begin() + first, out.end());
+}
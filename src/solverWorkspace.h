@@ -0,0 +1,54 @@
+#ifndef SOLVER_WORKSPACE_H
+#define SOLVER_WORKSPACE_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "adjacency.h"
+#include "eulerCircuit.h"
+#include "contractionHierarchy.h"
+
+/**
+ * @file solverWorkspace.h
+ * @brief Scratch buffers of the Chinese postman solver, reused across phases and solves.
+ */
+
+/**
+ * @brief Owns every temporary buffer of Graph::solveComponent.
+ *
+ * The buffers grow to the size of the largest graph solved so far and are never shrunk;
+ * reset() only clears them, so once warmed up a solve allocates nothing but its result.
+ * Use one workspace per thread (see forThisThread).
+ */
+struct SolverWorkspace {
+    // Shortest paths (shortestPathTree, ContractionHierarchy queries).
+    std::vector<int> dist;
+    std::vector<int> parent;
+    std::vector<int> key;  ///< Frontier distances of denseShortestPathTree.
+    std::vector<std::pair<int, int>> heap;
+
+    ChSearchBuffers hierarchySearch;
+
+    // Euler circuit (Graph::findEulerCycle).
+    std::vector<std::pair<int, int>> edges;
+    EulerScratch euler;
+
+    // Odd vertex matching of smallClosedWalk.
+    std::vector<int> matching;
+
+    // Edges added by Graph::makeGraphEulerian and the walk or path being expanded.
+    std::vector<std::pair<int, int>> added;
+    std::vector<std::pair<int, int>> duplicated;  ///< Multiset of graph edges walked once more.
+    std::vector<std::pair<int, int>> walk;
+
+    void reset();
+    std::size_t capacityBytes() const;
+
+    static SolverWorkspace& forThisThread();
+};
+
+void shortestPathTree(int start, int target, const std::vector<std::vector<int>>& adjMatrix,
+                      const AdjacencyIndex& adjacency, int vertices, SolverWorkspace& workspace);
+void appendPath(int start, int end, const std::vector<int>& parent, std::vector<std::pair<int, int>>& out);
+
+#endif // SOLVER_WORKSPACE_H
@@ -0,0 +1,101 @@
+#include "threadPool.h"
+#include "trace.h"
+#include <algorithm>
+
+/// Threads this thread may use for pools of its own; 0 off the workers of any pool.
+static thread_local unsigned threadShare = 0;
+
+/**
+ * @file threadPool.cpp
+ * @brief Starts the given number of worker threads (at least one).
+ *
+ * On a worker of another pool the number is capped at that worker's share, and a pool
+ * capped at one thread starts no workers: its tasks run inline.
+ *
+ * @param threads The number of workers to start.
+ */
+ThreadPool::ThreadPool(unsigned threads) {
+    threads = std::max(1u, threads);
+    if (threadShare != 0) {
+        threads = std::min(threads, threadShare);
+        if (threads == 1) {
+            return;
+        }
+    }
+    unsigned share = std::max(1u, defaultThreads() / threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([this, share]() {
+            threadShare = share;
+            workerLoop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Number of threads used when the caller does not specify one.
+ *
+ * @return The share of the threads of the pool worker this runs on; otherwise the hardware
+ *         concurrency, or 1 if it cannot be determined.
+ */
+unsigned ThreadPool::defaultThreads() {
+    if (threadShare != 0) {
+        return threadShare;
+    }
+    unsigned threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+/**
+ * @brief Runs body(begin, end) over [0, n) split into chunks on the pool and waits for all of them.
+ */
+void parallelFor(ThreadPool& pool, std::size_t n, const std::function<void(std::size_t, std::size_t)>& body) {
+    if (pool.size() == 0) {
+        if (n > 0) {
+            body(0, n);
+        }
+        return;
+    }
+    std::size_t chunks = std::min<std::size_t>(n, pool.size() * 4);
+    if (chunks == 0) {
+        return;
+    }
+    std::vector<std::future<void>> done;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        std::size_t begin = n * c / chunks;
+        std::size_t end = n * (c + 1) / chunks;
+        done.push_back(pool.submit([&body, begin, end]() {
+            TraceScope trace("parallel chunk", static_cast<long long>(end - begin));
+            body(begin, end);
+        }));
+    }
+    for (auto& f : done) {
+        f.get();
+    }
+}
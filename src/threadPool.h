@@ -0,0 +1,66 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @file threadPool.h
+ * @brief Fixed-size pool of worker threads fed from a single FIFO task queue.
+ *
+ * Tasks are submitted as callables and their results are returned through std::future.
+ * The destructor finishes the queued tasks before joining the workers.
+ *
+ * Pools nest without multiplying threads: every worker of a pool gets an equal share of
+ * the threads its creator had (defaultThreads), and a pool created on a worker gets at most
+ * that share. A pool left with a single thread there starts none and runs each task inline
+ * in submit, so solvers can create pools without knowing whether they already run on one.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = defaultThreads());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static unsigned defaultThreads();
+    /// The number of workers, 0 for a pool that runs its tasks inline.
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    template <typename F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using Result = decltype(f());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> result = task->get_future();
+        if (workers.empty()) {
+            (*task)();
+            return result;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([task]() { (*task)(); });
+        }
+        ready.notify_one();
+        return result;
+    }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping = false;
+};
+
+void parallelFor(ThreadPool& pool, std::size_t n, const std::function<void(std::size_t, std::size_t)>& body);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,100 @@
+#include "trace.h"
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    long long value;
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point end;
+};
+
+/// Events of one thread; only that thread appends to it.
+struct ThreadBuffer {
+    int id;
+    vector<TraceEvent> events;
+};
+
+mutex registryMutex;
+vector<unique_ptr<ThreadBuffer>> buffers;  ///< Outlive their threads, so pool workers may exit before writeTrace.
+chrono::steady_clock::time_point origin;
+thread_local ThreadBuffer* local = nullptr;
+
+ThreadBuffer& bufferForThisThread() {
+    if (!local) {
+        lock_guard<mutex> lock(registryMutex);
+        buffers.push_back(make_unique<ThreadBuffer>());
+        buffers.back()->id = static_cast<int>(buffers.size()) - 1;
+        buffers.back()->events.reserve(1024);
+        local = buffers.back().get();
+    }
+    return *local;
+}
+
+double microseconds(chrono::steady_clock::time_point t) {
+    return chrono::duration<double, micro>(t - origin).count();
+}
+
+} // namespace
+
+namespace trace {
+
+atomic<bool> enabled{false};
+
+void record(const char* name, long long value, chrono::steady_clock::time_point start) {
+    auto end = chrono::steady_clock::now();
+    bufferForThisThread().events.push_back({name, value, start, end});
+}
+
+} // namespace trace
+
+/**
+ * @brief Turns tracing on; the calling thread becomes thread 0, named "main" in the trace.
+ */
+void startTracing() {
+    origin = chrono::steady_clock::now();
+    bufferForThisThread();
+    trace::enabled.store(true, memory_order_relaxed);
+}
+
+/**
+ * @brief Writes all recorded events as a Chrome trace-event JSON file.
+ *
+ * Must be called once the threads that recorded events are finished or idle.
+ *
+ * @param path The output file.
+ * @return false if the file cannot be written.
+ */
+bool writeTrace(const string& path) {
+    ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    lock_guard<mutex> lock(registryMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << fixed << setprecision(3);
+    bool first = true;
+    for (const auto& buffer : buffers) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+            << ",\"name\":\"thread_name\",\"args\":{\"name\":\"" << (buffer->id == 0 ? "main" : "worker ")
+            << (buffer->id == 0 ? "" : to_string(buffer->id)) << "\"}}";
+        first = false;
+        for (const TraceEvent& event : buffer->events) {
+            out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"name\":\"" << event.name
+                << "\",\"ts\":" << microseconds(event.start) << ",\"dur\":" << microseconds(event.end) - microseconds(event.start);
+            if (event.value >= 0) {
+                out << ",\"args\":{\"n\":" << event.value << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
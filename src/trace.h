@@ -0,0 +1,56 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/**
+ * @file trace.h
+ * @brief Timeline of solver phases per thread, written in Chrome trace-event format (--trace).
+ *
+ * A TraceScope records one complete event (name, start, duration, thread) when it is
+ * destroyed. Events go to a buffer owned by the recording thread, so recording never takes a
+ * lock; a thread registers its buffer once, on its first event. While tracing is off a scope
+ * costs one relaxed atomic load. The file opens in chrome://tracing or ui.perfetto.dev.
+ */
+
+namespace trace {
+extern std::atomic<bool> enabled;
+void record(const char* name, long long value, std::chrono::steady_clock::time_point start);
+}
+
+/**
+ * @brief Records the lifetime of the scope as one trace event on the calling thread.
+ *
+ * @param name A string literal; it is stored, not copied.
+ * @param value Optional number shown as the event's argument (a generation, a size), -1 for none.
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, long long value = -1)
+        : name(trace::enabled.load(std::memory_order_relaxed) ? name : nullptr), value(value) {
+        if (this->name) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~TraceScope() {
+        if (name) {
+            trace::record(name, value, start);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    long long value;
+    std::chrono::steady_clock::time_point start;
+};
+
+void startTracing();
+bool writeTrace(const std::string& path);
+
+#endif // TRACE_H
@@ -0,0 +1,133 @@
+#include "vertexOrder.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+
+/// Neighbour lists in compressed form: the neighbours of x are target[offset[x] .. offset[x + 1]).
+struct Csr {
+    vector<int> offset;
+    vector<int> target;
+
+    Csr(int vertices, const vector<pair<int, int>>& edges) : offset(vertices + 1, 0), target(2 * edges.size()) {
+        for (const auto& [u, v] : edges) {
+            offset[u + 1]++;
+            offset[v + 1]++;
+        }
+        partial_sum(offset.begin(), offset.end(), offset.begin());
+        vector<int> fill(offset.begin(), offset.end() - 1);
+        for (const auto& [u, v] : edges) {
+            target[fill[u]++] = v;
+            target[fill[v]++] = u;
+        }
+    }
+
+    int degree(int x) const { return offset[x + 1] - offset[x]; }
+};
+
+/**
+ * @brief Appends the vertices reachable from start to sequence in BFS order.
+ *
+ * With byDegree the neighbours of every vertex are visited in increasing degree
+ * (Cuthill-McKee), otherwise in increasing index.
+ *
+ * @return The last vertex reached, which lies on the deepest BFS level.
+ */
+int breadthFirst(const Csr& graph, int start, bool byDegree, vector<char>& seen, vector<int>& sequence) {
+    size_t head = sequence.size();
+    seen[start] = 1;
+    sequence.push_back(start);
+    vector<int> next;
+    while (head < sequence.size()) {
+        int u = sequence[head++];
+        next.clear();
+        for (int i = graph.offset[u]; i < graph.offset[u + 1]; ++i) {
+            int v = graph.target[i];
+            if (!seen[v]) {
+                seen[v] = 1;
+                next.push_back(v);
+            }
+        }
+        if (byDegree) {
+            stable_sort(next.begin(), next.end(), [&graph](int a, int b) { return graph.degree(a) < graph.degree(b); });
+        }
+        sequence.insert(sequence.end(), next.begin(), next.end());
+    }
+    return sequence.back();
+}
+
+/**
+ * @brief Finds a pseudo-peripheral vertex of start's component: a vertex at the end of a
+ *        BFS from start, refined once more, which makes Cuthill-McKee levels narrow.
+ */
+int peripheralVertex(const Csr& graph, int start, vector<char>& seen) {
+    vector<int> sequence;
+    int far = start;
+    for (int round = 0; round < 2; ++round) {
+        sequence.clear();
+        far = breadthFirst(graph, far, false, seen, sequence);
+        for (int v : sequence) {
+            seen[v] = 0;
+        }
+    }
+    return far;
+}
+
+} // namespace
+
+/**
+ * @brief Computes a renumbering of the vertices.
+ *
+ * - Rcm: reverse Cuthill-McKee from a pseudo-peripheral vertex of every component,
+ *   which keeps the bandwidth of the adjacency matrix small.
+ * - Bfs: breadth-first order from the lowest vertex of every component.
+ * - Degree: decreasing degree, so hubs share cache lines.
+ * Isolated vertices keep their relative order at the end.
+ *
+ * @param vertices The number of vertices.
+ * @param edges The undirected edges.
+ * @param order The ordering to compute.
+ * @return newId, where newId[v] is the new number of vertex v.
+ */
+vector<int> computeVertexOrder(int vertices, const vector<pair<int, int>>& edges, VertexOrder order) {
+    vector<int> sequence;
+    sequence.reserve(vertices);
+    if (order == VertexOrder::Original) {
+        sequence.resize(vertices);
+        iota(sequence.begin(), sequence.end(), 0);
+    } else {
+        Csr graph(vertices, edges);
+        if (order == VertexOrder::Degree) {
+            sequence.resize(vertices);
+            iota(sequence.begin(), sequence.end(), 0);
+            stable_sort(sequence.begin(), sequence.end(), [&graph](int a, int b) { return graph.degree(a) > graph.degree(b); });
+        } else {
+            vector<char> seen(vertices, 0);
+            for (int v = 0; v < vertices; ++v) {
+                if (seen[v] || graph.degree(v) == 0) {
+                    continue;
+                }
+                size_t first = sequence.size();
+                if (order == VertexOrder::Rcm) {
+                    breadthFirst(graph, peripheralVertex(graph, v, seen), true, seen, sequence);
+                    reverse(sequence.begin() + first, sequence.end());
+                } else {
+                    breadthFirst(graph, v, false, seen, sequence);
+                }
+            }
+            for (int v = 0; v < vertices; ++v) {
+                if (graph.degree(v) == 0) {
+                    sequence.push_back(v);
+                }
+            }
+        }
+    }
+
+    vector<int> newId(vertices);
+    for (int i = 0; i < vertices; ++i) {
+        newId[sequence[i]] = i;
+    }
+    return newId;
+}
@@ -0,0 +1,15 @@
+#ifndef VERTEX_ORDER_H
+#define VERTEX_ORDER_H
+
+#include <utility>
+#include <vector>
+#include "options.h"
+
+/**
+ * @file vertexOrder.h
+ * @brief Vertex renumberings that place neighbouring vertices close together in memory.
+ */
+
+std::vector<int> computeVertexOrder(int vertices, const std::vector<std::pair<int, int>>& edges, VertexOrder order);
+
+#endif // VERTEX_ORDER_H
@@ -0,0 +1,75 @@
+#include "adjacency.h"
+#include "graphPartition.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+/**
+ * @file stitchPiecesTest.cpp
+ * @brief Regression tests of stitchPieces (make test).
+ */
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+AdjacencyIndex pathGraph(int vertices) {
+    AdjacencyIndex adjacency;
+    adjacency.reset(vertices, AdjacencyIndex::Layout::Sparse);
+    for (int v = 0; v + 1 < vertices; ++v) {
+        adjacency.add(v, v + 1);
+    }
+    return adjacency;
+}
+
+bool hasEdge(const std::vector<std::pair<int, int>>& edges, int u, int v) {
+    return std::any_of(edges.begin(), edges.end(), [u, v](const std::pair<int, int>& e) {
+        return (e.first == u && e.second == v) || (e.first == v && e.second == u);
+    });
+}
+
+}  // namespace
+
+int main() {
+    // Pieces {0-1} and {3-4} on the path 0-1-2-3-4: the gap is two edges long.
+    {
+        AdjacencyIndex adjacency = pathGraph(5);
+        std::vector<std::pair<int, int>> edges = {{0, 1}, {3, 4}};
+        stitchPieces(adjacency, 5, edges);
+        check(edges.size() == 4, "path 0-4: two joining edges");
+        check(hasEdge(edges, 1, 2) && hasEdge(edges, 2, 3), "path 0-4: joined over vertex 2");
+    }
+    // Three pieces with gaps of one and three edges on the path 0-...-8.
+    {
+        AdjacencyIndex adjacency = pathGraph(9);
+        std::vector<std::pair<int, int>> edges = {{0, 1}, {2, 3}, {6, 7}, {7, 8}};
+        stitchPieces(adjacency, 9, edges);
+        check(edges.size() == 8, "path 0-8: every gap edge added once");
+        for (int v = 0; v < 8; ++v) {
+            check(hasEdge(edges, v, v + 1), "path 0-8: path edge present");
+        }
+    }
+    // Pieces in different components stay apart.
+    {
+        AdjacencyIndex adjacency;
+        adjacency.reset(4, AdjacencyIndex::Layout::Sparse);
+        adjacency.add(0, 1);
+        adjacency.add(2, 3);
+        std::vector<std::pair<int, int>> edges = {{0, 1}, {2, 3}};
+        stitchPieces(adjacency, 4, edges);
+        check(edges.size() == 2, "two components: nothing added");
+    }
+
+    if (failures == 0) {
+        std::cout << "stitchPiecesTest: OK" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}